@@ -0,0 +1,32 @@
+# Writes the commit of the GGBoy-Core submodule into a header, executed on every build (see CMakeLists.txt).
+# The version stays empty if it is unknown or the core has local changes, fast boot snapshots are disabled then.
+set(CORE_VERSION "")
+find_package(Git QUIET)
+if (GIT_FOUND)
+	# Without submodule metadata git would report the commit of this repository instead
+	execute_process(COMMAND ${GIT_EXECUTABLE} rev-parse --show-toplevel
+					WORKING_DIRECTORY "${CORE_SOURCE_DIR}"
+					OUTPUT_VARIABLE CORE_TOPLEVEL
+					OUTPUT_STRIP_TRAILING_WHITESPACE
+					ERROR_QUIET)
+	get_filename_component(CORE_TOPLEVEL "${CORE_TOPLEVEL}" REALPATH)
+	get_filename_component(CORE_SOURCE_DIR_REAL "${CORE_SOURCE_DIR}" REALPATH)
+	execute_process(COMMAND ${GIT_EXECUTABLE} rev-parse HEAD
+					WORKING_DIRECTORY "${CORE_SOURCE_DIR}"
+					OUTPUT_VARIABLE CORE_COMMIT
+					OUTPUT_STRIP_TRAILING_WHITESPACE
+					RESULT_VARIABLE COMMIT_RESULT
+					ERROR_QUIET)
+	execute_process(COMMAND ${GIT_EXECUTABLE} diff --quiet HEAD
+					WORKING_DIRECTORY "${CORE_SOURCE_DIR}"
+					RESULT_VARIABLE DIRTY_RESULT
+					ERROR_QUIET)
+	if (COMMIT_RESULT EQUAL 0 AND DIRTY_RESULT EQUAL 0 AND CORE_COMMIT AND (CORE_TOPLEVEL STREQUAL CORE_SOURCE_DIR_REAL))
+		set(CORE_VERSION "${CORE_COMMIT}")
+	endif ()
+endif (GIT_FOUND)
+
+# Only replaced if the content changed, so an unchanged core does not cause a rebuild
+file(WRITE "${OUTPUT_FILE}.tmp" "#pragma once\n// Generated by cmake/CoreVersion.cmake, empty if the core version is unknown\n#define GGBOY_CORE_VERSION \"${CORE_VERSION}\"\n")
+configure_file("${OUTPUT_FILE}.tmp" "${OUTPUT_FILE}" COPYONLY)
+file(REMOVE "${OUTPUT_FILE}.tmp")
@@ -1,20 +1,42 @@
 #pragma once
+#include <atomic>
+#include <optional>
+#include <string>
 #include <Emulator.hpp>
 #include <SDL.h>
 
+#include "GameplayRecorder.hpp"
+#include "ThreadTuning.hpp"
+
 class Audio 
 {
 public:
-	Audio(ggb::SampleBuffer* sampleBuffer);
+	Audio(ggb::SampleBuffer* sampleBuffer, ThreadSettings threadSettings = {});
 	~Audio();
+	void setSampleBuffer(ggb::SampleBuffer* sampleBuffer);
+	// The played samples are additionally passed to the recorder, nullptr stops that
+	void setRecorder(GameplayRecorder* recorder);
 	void setAudioPlaying(bool value);
 	bool audioPlaying() const;
+	// Measures how late the callbacks of the audio device arrive, late callbacks are audible as underruns
+	JitterProbe& callbackJitter();
+	// Returns the description of the applied thread settings once, after the first callback applied them.
+	// The callback itself must not log, the emulator thread polls this instead
+	std::optional<std::string> takeThreadSettingsDescription();
 	
 private:
 	struct AudioData 
 	{
 		ggb::SampleBuffer* sampleBuffer = nullptr;
 		ggb::Frame lastReadFrame = {};
+		GameplayRecorder* recorder = nullptr;
+		// The audio thread is created by SDL, so the settings are applied by the first callback
+		ThreadSettings threadSettings = {};
+		std::string threadSettingsDescription;
+		std::atomic<bool> threadSettingsApplied{ false };
+		bool threadSettingsReported = false;
+		long long lastCallbackTime = 0;
+		JitterProbe callbackJitter;
 	};
 
 	bool initializeAudio(ggb::SampleBuffer* sampleBuffer);
@@ -0,0 +1,56 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/// Lock free single producer / single consumer queue with preallocated slots.
+/// The producer writes into a slot in place and never blocks, if the queue is full it has to drop its data.
+template <typename T, size_t Capacity>
+class BoundedQueue
+{
+public:
+	// Producer side, returns nullptr if the queue is full
+	T* acquireWriteSlot()
+	{
+		const auto head = m_head.load(std::memory_order_relaxed);
+		if (head - m_tail.load(std::memory_order_acquire) == Capacity)
+			return nullptr;
+		return &m_slots[head % Capacity];
+	}
+
+	void commitWrite()
+	{
+		m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Consumer side, returns nullptr if the queue is empty
+	T* acquireReadSlot()
+	{
+		const auto tail = m_tail.load(std::memory_order_relaxed);
+		if (m_head.load(std::memory_order_acquire) == tail)
+			return nullptr;
+		return &m_slots[tail % Capacity];
+	}
+
+	void commitRead()
+	{
+		m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Only allowed while neither producer nor consumer are active
+	void clear()
+	{
+		m_head = 0;
+		m_tail = 0;
+	}
+
+	std::array<T, Capacity>& storage()
+	{
+		return m_slots;
+	}
+
+private:
+	std::array<T, Capacity> m_slots = {};
+	alignas(64) std::atomic<size_t> m_head{ 0 };
+	alignas(64) std::atomic<size_t> m_tail{ 0 };
+};
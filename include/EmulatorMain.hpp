@@ -1,7 +1,10 @@
 #pragma once
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <iostream>
 #include <filesystem>
+#include <list>
 #include <mutex>
 #include <unordered_map>
 #include <Input.hpp>
@@ -13,8 +16,11 @@
 #include <RenderingUtility.hpp>
 
 #include "Video.hpp"
+#include "TileDataViewer.hpp"
+#include "GameplayRecorder.hpp"
 #include "Audio.hpp"
 #include "Inputhandling.hpp"
+#include "ThreadTuning.hpp"
 #include "SDL.h"
 
 struct KeyEvent 
@@ -23,46 +29,137 @@ struct KeyEvent
 	bool pressed;
 };
 
+enum class FastBootPoint
+{
+	AfterFrames,
+	FirstInput
+};
+
 class EmulatorThread : public QThread 
 {
 	Q_OBJECT
 public:
 	EmulatorThread(QObject* parent);
 	void setROM(std::filesystem::path path);
+	// Has to be called before the thread is started
+	void setThreadSettings(ThreadSettings emulatorThread, ThreadSettings audioThread);
 	void postEvent(KeyEvent event);
 	void quit();
+	// Called by the GUI once an image emitted by renderedImage is displayed
+	void acknowledgeFrame();
+	void setDisplayRefreshRate(double refreshRate);
+	// Speed used while fast forwarding (toggled with T), UNCAPPED_SPEED runs as fast as possible
+	void setFastForwardSpeed(double speed);
+	TileDataSnapshots* tileDataSnapshots();
+	// Starts / stops writing the gameplay to RECORDING_BASE_PATH, applied by the emulator thread
+	void setRecording(bool enabled);
+	// Restores cold started games from a snapshot taken at the given point of their first launch
+	void setFastBoot(bool enabled, FastBootPoint point = FastBootPoint::AfterFrames, int snapshotFrame = DEFAULT_FAST_BOOT_FRAME);
+	// Snapshots are bound to the core version, without a known version fast boot is not available
+	static bool isFastBootAvailable();
+
+	static constexpr int DEFAULT_FAST_BOOT_FRAME = 300;
+	static constexpr double UNCAPPED_SPEED = 1000.0;
 
 signals:
-	void renderedImage(QImage image);
+	// Only the rows [dirtyTop, dirtyBottom] differ from the previously emitted image
+	void renderedImage(QImage image, int dirtyTop, int dirtyBottom);
 	void currentMaxSpeedup(double speedUp);
+	// Measured emulation speed of the last second relative to the real hardware
+	void currentSpeed(double speed);
+	// Frame counts of the last second: converted and emitted / not converted / converted but identical to the previous one
+	void frameStatistics(qulonglong presentedFrames, qulonglong skippedFrames, qulonglong unchangedFrames);
+	// Deadline misses of the last second: emulated frames (only measured at 1x speed) and audio callbacks
+	void schedulingJitter(qulonglong missedFrameDeadlines, double maxFrameLatenessInMs, qulonglong lateAudioCallbacks, double maxAudioLatenessInMs);
 	void warning(QString errorString);
+	// Emitted every second while recording and once after the recording stopped
+	void recordingStatus(QString status, bool recording);
 
 protected:
 	void run() override;
 
 private:
+	struct CachedCartridge
+	{
+		std::filesystem::path path;
+		std::filesystem::file_time_type romWriteTime;
+		std::unique_ptr<ggb::Emulator> emulator;
+		QTRenderer* renderer = nullptr;
+	};
+
 	void performanceProfiling();
+	// Audio and controller handling are only needed once a game runs, so they are not created before the first ROM is loaded
+	void initializeSubsystems();
+	void createEmulator();
+	// The tile data is only rendered by the active emulator and only while a viewer is open
+	void updateTileDataRenderer();
+	void detachTileDataRenderer();
+	CachedCartridge takeActiveCartridge();
+	// Makes a cached cartridge the active one, returns false if the path is not cached (or the ROM changed on disk)
+	bool activateCachedCartridge(const std::filesystem::path& path);
+	// Cold loads a ROM together with its save files into a new emulator, the cartridge stays unloaded on failure
+	void reloadCartridge(const std::filesystem::path& path);
 	std::string getCartridgeName();
-	void loadRAM();
-	void loadRTC();
-	void loadROM(const std::filesystem::path& path);
+	// Returns the path of the loaded RAM file, empty if none was loaded
+	std::filesystem::path loadRAM();
+	bool loadRTC();
+	// Returns true if the game was restored from an existing snapshot, otherwise a snapshot gets scheduled
+	bool prepareFastBoot(const std::filesystem::path& loadedRAMPath);
+	void captureFastBootSnapshot();
+	// Snapshots of the same ROM for other save files or core versions are never used again
+	void removeSupersededSnapshots(const std::filesystem::path& snapshotPath);
+	void loadROM(const std::filesystem::path& path, long long requestTime = 0);
 	void saveCartridgeRAM();
 	void saveCartridgeRTC();
 	// Returns the path which file should be written / overwritten
 	std::filesystem::path getFileSavePath(const std::string& fileName, const std::string& fileExtension);
 	void updateInput();
+	void applyFastForwardSpeed();
+	void probeFrameDeadline(long long currentTime);
+	void emitSchedulingJitter();
+	void updateRecording();
+	void stopRecording();
+	// Called on the GUI thread once the recorder wrote its files
+	void recordingFinished();
+	QString recordingStatusText(bool recording) const;
 	void handleEmulatorKeyPress(int key);
 
 	std::unique_ptr<ggb::Emulator> m_emulator = nullptr;
 	std::unique_ptr<Audio> m_audioHandler = nullptr;
 	std::unique_ptr<InputHandler> m_inputHandler = nullptr;
-	//std::unique_ptr<QTRenderer> m_tileDataRenderer = nullptr;
 	QTRenderer* m_gameRenderer = nullptr;
+	TileDataRenderer* m_tileDataRenderer = nullptr;
+	TileDataSnapshots m_tileDataSnapshots;
+	PresentationFeedback m_presentationFeedback;
+	ThreadSettings m_emulatorThreadSettings = {};
+	ThreadSettings m_audioThreadSettings = {};
+	JitterProbe m_frameJitter;
+	const QTRenderer* m_probedRenderer = nullptr;
+	uint64_t m_lastProbedFrame = 0;
+	long long m_lastProbedFrameTime = 0;
+	GameplayRecorder m_recorder;
+	// Recently played cartridges including their cartridge RAM, most recently used first
+	std::list<CachedCartridge> m_cartridgeCache;
 	bool m_quit = false;
 	std::unordered_map<int, bool> m_keyStates;
 	std::vector<KeyEvent> m_pendingKeyEvents;
 	std::filesystem::path m_romToBeLoaded;
+	// Time setROM was called, the switch latency is measured from here
+	long long m_romRequestTime = 0;
+	// Set by setROM / quit, checked by the emulation loop after every batch of steps so a ROM switch is picked up right away
+	std::atomic<bool> m_emulatorEventPending{ false };
 	std::mutex m_inputMutex;
 	std::mutex m_emulatorEventsMutex;
+	std::condition_variable m_emulatorEventsCondition;
+	std::atomic<bool> m_fastBootEnabled{ false };
+	std::atomic<FastBootPoint> m_fastBootPoint{ FastBootPoint::AfterFrames };
+	std::atomic<int> m_fastBootFrame{ DEFAULT_FAST_BOOT_FRAME };
+	std::atomic<double> m_fastForwardSpeed{ 5.0 };
+	std::atomic<bool> m_recordingRequested{ false };
+	// Only set while the first launch of a ROM still has to take its fast boot snapshot
+	std::filesystem::path m_pendingFastBootSnapshot;
+	FastBootPoint m_pendingFastBootPoint = FastBootPoint::AfterFrames;
+	uint64_t m_fastBootCaptureFrame = 0;
 	static constexpr bool runPerformanceProfiling = false;
+	static constexpr size_t CARTRIDGE_CACHE_SIZE = 4;
 };
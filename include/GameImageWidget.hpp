@@ -0,0 +1,25 @@
+#pragma once
+#include <QWidget>
+#include <QImage>
+#include <QPixmap>
+
+/// Shows the upscaled game image. The widget owns its pixmap exclusively, so the changed rows are drawn into it
+/// without copying the whole pixmap and only their band of the widget is repainted.
+class GameImageWidget : public QWidget
+{
+	Q_OBJECT
+public:
+	GameImageWidget(QWidget* parent = nullptr);
+	// Rows outside of dirtyTop and dirtyBottom are expected to be unchanged since the last image
+	void updateImage(const QImage& image, int dirtyTop, int dirtyBottom);
+	QSize sizeHint() const override;
+	QSize minimumSizeHint() const override;
+
+	static constexpr int SCALE = 5;
+
+protected:
+	void paintEvent(QPaintEvent* event) override;
+
+private:
+	QPixmap m_pixmap;
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <QThread>
+#include <Emulator.hpp>
+#include <RenderingUtility.hpp>
+
+#include "BoundedQueue.hpp"
+
+/// Records the emulated frames as raw RGB24 stream with a timestamp file (variable frame rate) and the played audio as WAV file.
+/// The emulator and audio thread only copy into preallocated queue slots, the files are written by this thread.
+/// If the disk can not keep up, frames are dropped (and counted) instead of stalling the emulator. A dropped frame costs nothing,
+/// the timestamps of the written frames keep the video in sync with the audio.
+class GameplayRecorder : public QThread
+{
+	Q_OBJECT
+public:
+	struct Statistics
+	{
+		uint64_t writtenVideoFrames = 0;
+		uint64_t droppedVideoFrames = 0;
+		uint64_t writtenAudioFrames = 0;
+		uint64_t droppedAudioFrames = 0;
+	};
+
+	GameplayRecorder(QObject* parent = nullptr);
+	// Waits until the queued data is written, it is only discarded if that takes longer than the drain timeout
+	~GameplayRecorder();
+	// Creates <basePath>.rgb, <basePath>.timestamps.txt, <basePath>.wav and <basePath>.txt (how to convert the recording).
+	// Returns an error message on failure, fails as well while the previous recording is still being finished
+	std::string startRecording(const std::filesystem::path& basePath, int width, int height, double framesPerSecond);
+	// Does not block, the writer finishes the queued data in the background and emits finished() afterwards
+	void stopRecording();
+	bool isRecording() const;
+	Statistics statistics() const;
+	// Emulator thread, never blocks
+	void pushVideoFrame(const ggb::FrameBuffer& framebuffer);
+	// Audio thread, interleaved stereo samples, never blocks
+	void pushAudio(const ggb::AUDIO_FORMAT* samples, size_t frameCount);
+
+protected:
+	void run() override;
+
+private:
+	static constexpr size_t VIDEO_QUEUE_SIZE = 120;
+	static constexpr size_t AUDIO_QUEUE_SIZE = 64;
+	static constexpr size_t AUDIO_CHUNK_FRAMES = 1024;
+	static constexpr int CHANNEL_COUNT = 2;
+
+	struct VideoFrame
+	{
+		std::vector<uint8_t> pixels;
+		// Time since the recording started
+		long long timestamp = 0;
+	};
+
+	struct AudioChunk
+	{
+		std::array<ggb::AUDIO_FORMAT, AUDIO_CHUNK_FRAMES * CHANNEL_COUNT> samples = {};
+		size_t frameCount = 0;
+		// Audio frames which were dropped directly before this chunk
+		uint64_t droppedBefore = 0;
+	};
+
+	bool writeVideo();
+	bool writeAudio();
+	// Pads the audio with silence if it fell behind the video (e.g. while fast forwarding or paused, audio is not played then)
+	void synchronizeAudio();
+	void writeSilence(uint64_t frameCount);
+	void writeWavHeader(uint64_t audioFrames);
+
+	BoundedQueue<VideoFrame, VIDEO_QUEUE_SIZE> m_videoQueue;
+	BoundedQueue<AudioChunk, AUDIO_QUEUE_SIZE> m_audioQueue;
+	std::atomic<bool> m_recording{ false };
+	std::atomic<bool> m_discardQueued{ false };
+	std::atomic<uint64_t> m_writtenVideoFrames{ 0 };
+	std::atomic<uint64_t> m_droppedVideoFrames{ 0 };
+	std::atomic<uint64_t> m_writtenAudioFrames{ 0 };
+	std::atomic<uint64_t> m_droppedAudioFrames{ 0 };
+	// Only accessed by the producing threads
+	long long m_startTime = 0;
+	long long m_lastPushedTimestamp = -1;
+	uint64_t m_pendingDroppedAudioFrames = 0;
+	// Only accessed by the writer thread
+	long long m_lastWrittenTimestamp = 0;
+	std::vector<char> m_silence;
+	std::ofstream m_videoFile;
+	std::ofstream m_timestampFile;
+	std::ofstream m_audioFile;
+	double m_framesPerSecond = 60.0;
+	int m_width = 0;
+	int m_height = 0;
+};
@@ -10,6 +10,9 @@ class InformationWindow : public QWidget
 public:
 	InformationWindow(QWidget* parent = nullptr);
 	void addSpeedup(double speedUp);
+	void setCurrentSpeed(double speed);
+	void addFrameStatistics(qulonglong presentedFrames, qulonglong skippedFrames, qulonglong unchangedFrames);
+	void addSchedulingJitter(qulonglong missedFrameDeadlines, double maxFrameLatenessInMs, qulonglong lateAudioCallbacks, double maxAudioLatenessInMs);
 
 private:
 	void updateInformations();
@@ -19,4 +22,7 @@ private:
 	const size_t m_maxSizeForSpeedups = 10;
 	size_t m_currentIndex = 0;
 	bool m_wrappedAround = false;
+	qulonglong m_unchangedFrames = 0;
+	qulonglong m_missedFrameDeadlines = 0;
+	qulonglong m_lateAudioCallbacks = 0;
 };
\ No newline at end of file
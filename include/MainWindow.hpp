@@ -3,10 +3,15 @@
 #include <QWindow>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QElapsedTimer>
+#include <QActionGroup>
 
 #include <memory>
 
 #include "InformationWindow.hpp"
+#include "RomLibrary.hpp"
+#include "RomLibraryWindow.hpp"
+#include "TileDataWindow.hpp"
 #include "EmulatorMain.hpp"
 
 #include "ui_mainwindow.h"
@@ -15,16 +20,29 @@ class MainWindow : public QMainWindow
 {
 	Q_OBJECT
 public:
-	MainWindow();
+	MainWindow(QElapsedTimer startupTimer, ThreadSettings emulatorThreadSettings = {}, ThreadSettings audioThreadSettings = {},
+		int fastBootFrame = EmulatorThread::DEFAULT_FAST_BOOT_FRAME);
 	 ~MainWindow();
+	void loadROM(const QString& fileName);
 public slots:
 	void currentMaxSpeedup(double speedUp);
-	void updateImage(QImage image);
+	void currentSpeed(double speed);
+	void updateImage(QImage image, int dirtyTop, int dirtyBottom);
+	void frameStatistics(qulonglong presentedFrames, qulonglong skippedFrames, qulonglong unchangedFrames);
+	void schedulingJitter(qulonglong missedFrameDeadlines, double maxFrameLatenessInMs, qulonglong lateAudioCallbacks, double maxAudioLatenessInMs);
 	void warning(QString errorString);
+	void recordingStatus(QString status, bool recording);
 
 private:
 	void openROM();
 	void toggleInformationWindow();
+	void toggleRomLibraryWindow();
+	void toggleTileDataWindow();
+	void updateFastBoot();
+	void fastForwardSpeedSelected(QAction* action);
+	// Frames are paced to the refresh rate of the screen the window is currently on
+	void screenChanged(QScreen* screen);
+	void showEvent(QShowEvent* event) override;
 	void keyPressEvent(QKeyEvent* event) override;
 	void keyReleaseEvent(QKeyEvent* event) override;
 
@@ -33,5 +51,17 @@ private:
 	Ui::MainWindow* m_ui = nullptr;
 	EmulatorThread* m_emulatorThread = nullptr;
 	std::unique_ptr<InformationWindow> m_informationWindow = nullptr;
+	RomLibrary* m_romLibrary = nullptr;
+	std::unique_ptr<RomLibraryWindow> m_romLibraryWindow = nullptr;
+	std::unique_ptr<TileDataWindow> m_tileDataWindow = nullptr;
+	std::filesystem::path m_currentROM;
+	QImage m_lastImage;
+	// Measures the time from process start until the window and the first frame are shown
+	QElapsedTimer m_startupTimer;
+	qint64 m_windowShownTime = -1;
+	bool m_firstFrameShown = false;
+	// Frames after a cold start at which the fast boot snapshot is taken
+	int m_fastBootFrame = EmulatorThread::DEFAULT_FAST_BOOT_FRAME;
+	QMetaObject::Connection m_refreshRateConnection;
 };
 
@@ -0,0 +1,121 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <QThread>
+#include <QImage>
+#include <QString>
+
+struct RomInfo
+{
+	std::filesystem::path path;
+	std::string title;
+	uint8_t cgbFlag = 0;
+	uint8_t cartridgeType = 0;
+	uint32_t crc = 0;
+	uint64_t fileSize = 0;
+	// Raw file time, only used to detect changed files
+	int64_t lastModified = 0;
+	// Seconds since epoch, 0 if never played
+	int64_t lastPlayed = 0;
+};
+
+// Absolute and normalized, so the same ROM is always identified by the same path
+std::filesystem::path normalizedRomPath(const std::filesystem::path& path);
+/// Parses the cartridge header, only the first page of the file is mapped into memory
+bool readRomHeader(const std::filesystem::path& path, RomInfo& info);
+uint32_t calculateFileCRC(const std::filesystem::path& path);
+QString cartridgeTypeName(uint8_t cartridgeType);
+QString cgbFlagName(uint8_t cgbFlag);
+
+class RomLibraryScanner : public QThread
+{
+	Q_OBJECT
+public:
+	RomLibraryScanner(std::filesystem::path gamesPath, std::filesystem::path thumbnailPath, std::vector<RomInfo> knownEntries,
+		std::set<uint32_t> loadedThumbnails, QObject* parent);
+	std::vector<RomInfo> takeResult();
+	// Thumbnails of the found ROMs which were not loaded before
+	std::unordered_map<uint32_t, QImage> takeThumbnails();
+
+signals:
+	void progress(int scannedFiles, int hashedFiles);
+
+protected:
+	void run() override;
+
+private:
+	std::filesystem::path m_gamesPath;
+	std::filesystem::path m_thumbnailPath;
+	std::vector<RomInfo> m_knownEntries;
+	std::set<uint32_t> m_loadedThumbnails;
+	std::vector<RomInfo> m_result;
+	std::unordered_map<uint32_t, QImage> m_thumbnails;
+};
+
+/// Writes the cache and thumbnails in the background, the jobs are executed in the order they were posted
+class RomLibraryWriter : public QThread
+{
+	Q_OBJECT
+public:
+	RomLibraryWriter(QObject* parent);
+	~RomLibraryWriter();
+	void post(std::function<void()> job);
+
+protected:
+	void run() override;
+
+private:
+	std::deque<std::function<void()>> m_jobs;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_stop = false;
+};
+
+class RomLibrary : public QObject
+{
+	Q_OBJECT
+public:
+	RomLibrary(std::filesystem::path gamesPath, std::filesystem::path cachePath, QObject* parent);
+	~RomLibrary();
+	// Loads the cache once, cheap enough to be called when the library view is opened
+	void ensureLoaded();
+	// Rescans the games directory on a background thread, only new or changed files are hashed again
+	void refresh();
+	bool isRefreshing() const;
+	const std::vector<RomInfo>& entries() const;
+	// Only returns thumbnails which are already loaded, they are loaded by refresh
+	QImage thumbnail(uint32_t crc) const;
+	std::filesystem::path gamesPath() const;
+	void setLastPlayed(const std::filesystem::path& path);
+	void setThumbnail(const std::filesystem::path& path, const QImage& image);
+
+signals:
+	void libraryChanged();
+	void refreshProgress(int scannedFiles, int hashedFiles);
+
+private:
+	void scanFinished();
+	void thumbnailSaved(uint32_t crc, QImage thumbnail);
+	RomInfo* findEntry(const std::filesystem::path& path);
+	void loadCache();
+	void saveCache();
+
+	std::filesystem::path m_gamesPath;
+	std::filesystem::path m_cachePath;
+	std::filesystem::path m_thumbnailPath;
+	std::vector<RomInfo> m_entries;
+	std::unordered_map<uint32_t, QImage> m_thumbnails;
+	// Last played times set in this session, they also apply to a cache which is loaded later
+	std::unordered_map<std::string, int64_t> m_lastPlayed;
+	RomLibraryScanner* m_scanner = nullptr;
+	RomLibraryWriter* m_writer = nullptr;
+	bool m_loaded = false;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <QWidget>
+#include <QString>
+
+#include "RomLibrary.hpp"
+#include "ui_romlibrarywindow.h"
+
+class RomLibraryWindow : public QWidget
+{
+	Q_OBJECT
+public:
+	RomLibraryWindow(RomLibrary* library, QWidget* parent = nullptr);
+
+signals:
+	void romSelected(QString path);
+
+protected:
+	void showEvent(QShowEvent* event) override;
+
+private:
+	void updateEntries();
+	void refreshProgress(int scannedFiles, int hashedFiles);
+	void entryActivated(int row, int column);
+
+	Ui::RomLibraryWindow* m_ui;
+	RomLibrary* m_library = nullptr;
+};
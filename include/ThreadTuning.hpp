@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+enum class ThreadPriority
+{
+	Normal,
+	// Raised nice level / above normal priority
+	High,
+	// SCHED_FIFO / time critical, falls back to High if not permitted.
+	// Only for threads which block regularly (e.g. audio), a busy thread would starve the rest of the system
+	Realtime
+};
+
+struct ThreadSettings
+{
+	// Core the thread gets pinned to, -1 lets the OS decide
+	int cpu = -1;
+	ThreadPriority priority = ThreadPriority::Normal;
+};
+
+std::optional<ThreadPriority> threadPriorityFromString(const std::string& name);
+/// Applies the settings to the calling thread, the thread keeps running with what could be applied.
+/// Returns a description of the applied settings including the failures, nothing is logged so it can be called from the audio callback
+std::string applyThreadSettings(const ThreadSettings& settings, const std::string& threadName);
+
+/// Measures how late a periodically running thread is, e.g. frames of the emulator or callbacks of the audio device.
+/// Samples can be added from a different thread than the one reading the statistics.
+class JitterProbe
+{
+public:
+	struct Statistics
+	{
+		uint64_t samples = 0;
+		// Samples which were late by more than DEADLINE_TOLERANCE of their interval
+		uint64_t deadlineMisses = 0;
+		long long maxLatenessInNanoSeconds = 0;
+	};
+
+	void addSample(long long expectedIntervalInNanoSeconds, long long actualIntervalInNanoSeconds);
+	// Statistics since the last call
+	Statistics takeStatistics();
+	// Statistics since the probe was created
+	Statistics totalStatistics() const;
+
+	static constexpr double DEADLINE_TOLERANCE = 0.5;
+
+private:
+	std::atomic<uint64_t> m_samples{ 0 };
+	std::atomic<uint64_t> m_deadlineMisses{ 0 };
+	std::atomic<long long> m_maxLateness{ 0 };
+	std::atomic<uint64_t> m_totalSamples{ 0 };
+	std::atomic<uint64_t> m_totalDeadlineMisses{ 0 };
+	std::atomic<long long> m_totalMaxLateness{ 0 };
+};
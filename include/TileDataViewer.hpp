@@ -0,0 +1,73 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <RenderingUtility.hpp>
+#include <QThread>
+#include <QImage>
+
+/// Lock free triple buffer, the emulator thread publishes snapshots of the tile data the viewer thread picks up
+class TileDataSnapshots
+{
+public:
+	struct Snapshot
+	{
+		// Raw copy of the core framebuffer, converting it is left to the viewer thread.
+		// Once the buffer exists, assigning the next frame reuses its storage
+		std::optional<ggb::FrameBuffer> framebuffer;
+	};
+
+	// Writer side (emulator thread)
+	Snapshot& backBuffer();
+	void publish();
+	// Reader side (viewer thread), returns nullptr if nothing new was published since the last call
+	const Snapshot* takeLatest();
+
+	// The renderer does nothing as long as no viewer is open
+	std::atomic<bool> enabled{ false };
+
+private:
+	static constexpr int NEW_SNAPSHOT_BIT = 4;
+	static constexpr int INDEX_MASK = 3;
+
+	std::array<Snapshot, 3> m_buffers;
+	std::atomic<int> m_latest{ 1 };
+	int m_backIndex = 0;
+	int m_frontIndex = 2;
+};
+
+class TileDataRenderer : public ggb::Renderer
+{
+public:
+	TileDataRenderer(TileDataSnapshots* snapshots);
+	void renderNewFrame(const ggb::FrameBuffer& framebuffer) override;
+
+private:
+	TileDataSnapshots* m_snapshots = nullptr;
+	int m_frameCounter = 0;
+};
+
+/// Converts each new snapshot and compares it tile by tile with the previous one, only the tiles which changed are written to the image
+class TileDataViewerThread : public QThread
+{
+	Q_OBJECT
+public:
+	TileDataViewerThread(TileDataSnapshots* snapshots, QObject* parent);
+
+signals:
+	void tileDataUpdated(QImage image, int changedTiles, int totalTiles);
+
+protected:
+	void run() override;
+
+private:
+	// Returns the number of tiles which changed
+	int updateImage(const TileDataSnapshots::Snapshot& snapshot);
+
+	TileDataSnapshots* m_snapshots = nullptr;
+	std::vector<uint32_t> m_pixels;
+	std::vector<uint32_t> m_previousPixels;
+	QImage m_image;
+};
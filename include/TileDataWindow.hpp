@@ -0,0 +1,26 @@
+#pragma once
+#include <QWidget>
+#include <QImage>
+
+#include "TileDataViewer.hpp"
+#include "ui_tiledatawindow.h"
+
+class TileDataWindow : public QWidget
+{
+	Q_OBJECT
+public:
+	TileDataWindow(TileDataSnapshots* snapshots, QWidget* parent = nullptr);
+	~TileDataWindow();
+
+protected:
+	void showEvent(QShowEvent* event) override;
+	void hideEvent(QHideEvent* event) override;
+
+private:
+	void tileDataUpdated(QImage image, int changedTiles, int totalTiles);
+	void stopViewerThread();
+
+	Ui::TileDataWindow* m_ui;
+	TileDataSnapshots* m_snapshots = nullptr;
+	TileDataViewerThread* m_viewerThread = nullptr;
+};
@@ -1,20 +1,63 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
 #include <RenderingUtility.hpp>
 #include <QImage>
 
+#include "GameplayRecorder.hpp"
+
+// Shared between the emulator thread and the GUI thread, tells the renderers how much the GUI can currently display
+struct PresentationFeedback
+{
+	// Images which were handed to the GUI but not yet displayed
+	std::atomic<int> framesInFlight{ 0 };
+	std::atomic<double> displayRefreshRate{ 60.0 };
+	// Statistics, only accessed on the emulator thread
+	uint64_t emulatedFrames = 0;
+	uint64_t presentedFrames = 0;
+	uint64_t skippedFrames = 0;
+	uint64_t unchangedFrames = 0;
+};
+
+// Rows [top, bottom] which changed since the last image returned by getCurrentImage
+struct DirtyRows
+{
+	int top = 0;
+	int bottom = -1;
+};
+
 class QTRenderer : public ggb::Renderer
 {
 public:
-	QTRenderer(int width, int height);
+	QTRenderer(int width, int height, PresentationFeedback* feedback = nullptr, GameplayRecorder* recorder = nullptr);
 	void renderNewFrame(const ggb::FrameBuffer& framebuffer) override;
 	bool hasNewImage() const;
+	DirtyRows dirtyRows() const;
 	QImage getCurrentImage();
+	// The next image is reported as completely dirty, e.g. because the GUI showed an image of another renderer
+	void forceFullUpdate();
+	// Uses a fixed frame skip instead of the adaptive presentation, 0 disables it
 	void setFrameSkip(int skipFrames);
+	// Number of frames the emulator produced so far, including skipped ones
+	uint64_t frameCount() const;
 
 private:
+	bool shouldConvertFrame();
+
+	PresentationFeedback* m_feedback = nullptr;
+	GameplayRecorder* m_recorder = nullptr;
+	uint64_t m_frameCount = 0;
+	long long m_lastFrameTime = 0;
+	long long m_lastPresentationTime = 0;
+	long long m_nextPresentationTime = 0;
+	double m_averageFrameInterval = 0.0;
 	int m_frameSkipCount = 0;
 	int m_skipImageCounter = 0;
 	bool m_hasNewImage = false;
+	bool m_fullUpdate = true;
+	DirtyRows m_dirtyRows = {};
+	std::vector<QRgb> m_lineBuffer;
 	QImage m_image;
 	int m_width;
 	int m_height;
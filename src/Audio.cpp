@@ -1,9 +1,13 @@
 #include "Audio.hpp"
 
+#include <cstdio>
+#include <RenderingUtility.hpp>
+
 static constexpr int CHANNEL_COUNT = 2;
 
-Audio::Audio(ggb::SampleBuffer* sampleBuffer)
+Audio::Audio(ggb::SampleBuffer* sampleBuffer, ThreadSettings threadSettings)
 {
+	m_data.threadSettings = threadSettings;
 	initializeAudio(sampleBuffer);
 }
 
@@ -12,10 +16,28 @@ Audio::~Audio()
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
 }
 
+void Audio::setSampleBuffer(ggb::SampleBuffer* sampleBuffer)
+{
+	SDL_LockAudioDevice(m_deviceID);
+	m_data.sampleBuffer = sampleBuffer;
+	SDL_UnlockAudioDevice(m_deviceID);
+}
+
+void Audio::setRecorder(GameplayRecorder* recorder)
+{
+	SDL_LockAudioDevice(m_deviceID);
+	m_data.recorder = recorder;
+	SDL_UnlockAudioDevice(m_deviceID);
+}
+
 void Audio::setAudioPlaying(bool value)
 {
 	if (value && !m_audioPlaying)
+	{
+		// The callback does not run while paused, the pause itself must not count as late callback
+		m_data.lastCallbackTime = 0;
 		SDL_PauseAudioDevice(m_deviceID, 0);
+	}
 	else if (!value && m_audioPlaying)
 		SDL_PauseAudioDevice(m_deviceID, 1);
 	m_audioPlaying = value;
@@ -26,6 +48,20 @@ bool Audio::audioPlaying() const
 	return m_audioPlaying;
 }
 
+JitterProbe& Audio::callbackJitter()
+{
+	return m_data.callbackJitter;
+}
+
+std::optional<std::string> Audio::takeThreadSettingsDescription()
+{
+	if (m_data.threadSettingsReported || !m_data.threadSettingsApplied)
+		return std::nullopt;
+
+	m_data.threadSettingsReported = true;
+	return m_data.threadSettingsDescription;
+}
+
 bool Audio::initializeAudio(ggb::SampleBuffer* sampleBuffer)
 {
 	m_data.sampleBuffer = sampleBuffer;
@@ -67,6 +103,20 @@ void Audio::emulatorAudioCallback(void* userdata, uint8_t* stream, int len)
 	static const int volume = 15;
 	const auto count = len / (sizeof(ggb::AUDIO_FORMAT) * CHANNEL_COUNT);
 
+	if (!audioData->threadSettingsApplied)
+	{
+		audioData->threadSettingsDescription = applyThreadSettings(audioData->threadSettings, "Audio thread");
+		audioData->threadSettingsApplied = true;
+	}
+
+	const auto currentTime = ggb::getCurrentTimeInNanoSeconds();
+	if (audioData->lastCallbackTime != 0)
+	{
+		const auto expectedInterval = static_cast<long long>(count) * 1000000000 / ggb::STANDARD_SAMPLE_RATE;
+		audioData->callbackJitter.addSample(expectedInterval, currentTime - audioData->lastCallbackTime);
+	}
+	audioData->lastCallbackTime = currentTime;
+
 	for (size_t sid = 0; sid < count; ++sid)
 	{
 		// As a default use the last read value, this prevents audio pops
@@ -75,4 +125,7 @@ void Audio::emulatorAudioCallback(void* userdata, uint8_t* stream, int len)
 		audioStream[2 * sid + 0] = audioData->lastReadFrame.leftSample * volume; /* L */
 		audioStream[2 * sid + 1] = audioData->lastReadFrame.rightSample * volume; /* R */
 	}
+
+	if (audioData->recorder)
+		audioData->recorder->pushAudio(audioStream, count);
 }
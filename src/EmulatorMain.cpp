@@ -1,17 +1,24 @@
 #include "EmulatorMain.hpp"
 
 #include <chrono>
+#include <iomanip>
 #include <regex>
+#include <sstream>
+
+#include "CoreVersion.hpp"
+#include "RomLibrary.hpp"
 
 static std::filesystem::path cartridgePath = "";
 static const std::filesystem::path SAVE_STATE_BASE_PATH = "Savestates/";
 static const std::filesystem::path RAM_BASE_PATH = "RAM/";
 static const std::filesystem::path CARTRIDGE_DATA_BASE_PATH = "CARTRIDGE_DATA/";
-static const std::filesystem::path GAMES_BASE_PATH = "Roms/Games/";
+static const std::filesystem::path FAST_BOOT_BASE_PATH = "Savestates/FastBoot/";
+static const std::filesystem::path RECORDING_BASE_PATH = "Recordings/";
 static const std::string RAM_FILE_ENDING = ".bin";
 static const std::string RAM_FILE_SUFFIX = "_ram";
 static const std::string RTC_FILE_SUFFIX = "_RTC";
 static const std::string SAVESTATE_FILE_ENDING = ".bin";
+static constexpr double GAMEBOY_FRAMES_PER_SECOND = 59.7275;
 
 namespace
 {
@@ -92,28 +99,39 @@ static std::vector<std::pair<std::filesystem::path, std::time_t>> getFilePaths(c
 	return files;
 }
 
-EmulatorThread::EmulatorThread(QObject* parent) : QThread(parent)
+static std::string toHexString(uint32_t value)
 {
-	m_emulator = std::make_unique<ggb::Emulator>();
-	m_audioHandler = std::make_unique<Audio>(m_emulator->getSampleBuffer());
-	m_inputHandler = std::make_unique<InputHandler>();
+	std::stringstream stream;
+	stream << std::hex << std::uppercase << std::setw(8) << std::setfill('0') << value;
+	return stream.str();
+}
 
-	auto tileDataDimensions = m_emulator->getTileDataDimensions();
-	auto gameWindowDimensions = m_emulator->getGameWindowDimensions();
-	//m_tileDataRenderer = std::make_unique<SDLRenderer>(tileDataDimensions.width, tileDataDimensions.height, 4);
-	auto gameRenderer = std::make_unique<QTRenderer>(gameWindowDimensions.width, gameWindowDimensions.height);
-	m_gameRenderer = gameRenderer.get();
+static bool isAnyButtonPressed(const ggb::GameboyInput& input)
+{
+	return input.isAPressed || input.isBPressed || input.isStartPressed || input.isSelectPressed
+		|| input.isUpPressed || input.isDownPressed || input.isLeftPressed || input.isRightPressed;
+}
 
-	m_emulator->setGameRenderer(std::move(gameRenderer));
+static std::filesystem::file_time_type romWriteTime(const std::filesystem::path& path)
+{
+	std::error_code ec;
+	return std::filesystem::last_write_time(path, ec);
+}
 
-	if constexpr (runPerformanceProfiling)
-		performanceProfiling();
+EmulatorThread::EmulatorThread(QObject* parent) : QThread(parent)
+{
+	connect(&m_recorder, &QThread::finished, this, &EmulatorThread::recordingFinished);
 }
 
 void EmulatorThread::setROM(std::filesystem::path path)
 {
-	std::scoped_lock lock(m_emulatorEventsMutex);
-	m_romToBeLoaded = std::move(path);
+	{
+		std::scoped_lock lock(m_emulatorEventsMutex);
+		m_romToBeLoaded = std::move(path);
+		m_romRequestTime = ggb::getCurrentTimeInNanoSeconds();
+	}
+	m_emulatorEventPending = true;
+	m_emulatorEventsCondition.notify_one();
 }
 
 void EmulatorThread::postEvent(KeyEvent event)
@@ -122,10 +140,65 @@ void EmulatorThread::postEvent(KeyEvent event)
 	m_pendingKeyEvents.emplace_back(std::move(event));
 }
 
+void EmulatorThread::setThreadSettings(ThreadSettings emulatorThread, ThreadSettings audioThread)
+{
+	m_emulatorThreadSettings = emulatorThread;
+	m_audioThreadSettings = audioThread;
+	// The emulator loop never sleeps while running, with SCHED_FIFO it could starve every other thread on its core
+	if (m_emulatorThreadSettings.priority == ThreadPriority::Realtime)
+	{
+		fprintf(stderr, "Realtime priority is not supported for the emulator thread, using high priority instead\n");
+		m_emulatorThreadSettings.priority = ThreadPriority::High;
+	}
+}
+
 void EmulatorThread::quit()
 {
-	std::scoped_lock lock(m_emulatorEventsMutex);
-	m_quit = true;
+	{
+		std::scoped_lock lock(m_emulatorEventsMutex);
+		m_quit = true;
+	}
+	m_emulatorEventPending = true;
+	m_emulatorEventsCondition.notify_one();
+}
+
+void EmulatorThread::acknowledgeFrame()
+{
+	if (m_presentationFeedback.framesInFlight > 0)
+		m_presentationFeedback.framesInFlight--;
+}
+
+void EmulatorThread::setDisplayRefreshRate(double refreshRate)
+{
+	if (refreshRate > 0.0)
+		m_presentationFeedback.displayRefreshRate = refreshRate;
+}
+
+void EmulatorThread::setFastForwardSpeed(double speed)
+{
+	m_fastForwardSpeed = speed;
+}
+
+TileDataSnapshots* EmulatorThread::tileDataSnapshots()
+{
+	return &m_tileDataSnapshots;
+}
+
+void EmulatorThread::setRecording(bool enabled)
+{
+	m_recordingRequested = enabled;
+}
+
+void EmulatorThread::setFastBoot(bool enabled, FastBootPoint point, int snapshotFrame)
+{
+	m_fastBootPoint = point;
+	m_fastBootFrame = snapshotFrame;
+	m_fastBootEnabled = enabled;
+}
+
+bool EmulatorThread::isFastBootAvailable()
+{
+	return std::string(GGBOY_CORE_VERSION).size() > 0;
 }
 
 void EmulatorThread::run()
@@ -134,41 +207,84 @@ void EmulatorThread::run()
 	static constexpr int UPDATE_AFTER_STEPS = 40;
 
 	bool running = true;
+	std::cout << applyThreadSettings(m_emulatorThreadSettings, "Emulator thread") << std::endl;
 
-	auto maxSpeedupTimer = Timer(NANO_SECONDS_PER_SECOND, [this]()
+	PresentationFeedback lastStatistics = {};
+	long long lastStatisticsTime = ggb::getCurrentTimeInNanoSeconds();
+	auto maxSpeedupTimer = Timer(NANO_SECONDS_PER_SECOND, [this, &lastStatistics, &lastStatisticsTime]()
 	{
 		emit currentMaxSpeedup(m_emulator->getMaxSpeedup());
+
+		const auto currentTime = ggb::getCurrentTimeInNanoSeconds();
+		const auto elapsedSeconds = static_cast<double>(currentTime - lastStatisticsTime) / NANO_SECONDS_PER_SECOND;
+		const auto emulatedFrames = m_presentationFeedback.emulatedFrames - lastStatistics.emulatedFrames;
+		if (elapsedSeconds > 0.0)
+			emit currentSpeed(emulatedFrames / elapsedSeconds / GAMEBOY_FRAMES_PER_SECOND);
+		lastStatistics.emulatedFrames = m_presentationFeedback.emulatedFrames;
+		lastStatisticsTime = currentTime;
+
+		const auto& statistics = m_presentationFeedback;
+		emit frameStatistics(statistics.presentedFrames - lastStatistics.presentedFrames, statistics.skippedFrames - lastStatistics.skippedFrames,
+			statistics.unchangedFrames - lastStatistics.unchangedFrames);
+		lastStatistics.presentedFrames = statistics.presentedFrames;
+		lastStatistics.skippedFrames = statistics.skippedFrames;
+		lastStatistics.unchangedFrames = statistics.unchangedFrames;
+
+		if (m_recorder.isRecording())
+			emit recordingStatus(recordingStatusText(true), true);
+
+		emitSchedulingJitter();
 	});
 
 	auto inputTimer = Timer(NANO_SECONDS_PER_SECOND / 100, [this]()
 	{
 		updateInput();
+		applyFastForwardSpeed();
 	});
 
-	auto emulatorEventsTimer = Timer(NANO_SECONDS_PER_SECOND / 3, [this, &running]()
+	auto handleEmulatorEvents = [this, &running]()
 	{
-		std::scoped_lock lock(m_emulatorEventsMutex);
-		running = !m_quit;
-		if (m_romToBeLoaded.empty())
-			return;
-		loadROM(m_romToBeLoaded);
-		m_romToBeLoaded.clear();
+		std::filesystem::path romToBeLoaded;
+		long long requestTime = 0;
+		{
+			std::scoped_lock lock(m_emulatorEventsMutex);
+			m_emulatorEventPending = false;
+			running = !m_quit;
+			romToBeLoaded = std::move(m_romToBeLoaded);
+			m_romToBeLoaded.clear();
+			requestTime = m_romRequestTime;
+		}
+
+		if (running && !romToBeLoaded.empty())
+			loadROM(romToBeLoaded, requestTime);
+	};
+
+	auto emulatorEventsTimer = Timer(NANO_SECONDS_PER_SECOND / 3, [this]()
+	{
+		updateTileDataRenderer();
+		updateRecording();
 	});
 
-	auto noCartridgeLoadedLoop = [this, &running, &emulatorEventsTimer]()
+	// Sleeps until the first ROM is requested, everything else is initialized lazily by loadROM
+	auto noCartridgeLoadedLoop = [this, &running, &handleEmulatorEvents]()
 	{
-		long long lastTimeStamp = ggb::getCurrentTimeInNanoSeconds();
-		while (running && !m_emulator->isCartridgeLoaded())
+		while (running && !(m_emulator && m_emulator->isCartridgeLoaded()))
 		{
-			const auto currentTime = ggb::getCurrentTimeInNanoSeconds();
-			const auto timePast = currentTime - lastTimeStamp;
-			emulatorEventsTimer.update(timePast);
+			{
+				std::unique_lock lock(m_emulatorEventsMutex);
+				m_emulatorEventsCondition.wait(lock, [this]() { return m_quit || !m_romToBeLoaded.empty(); });
+			}
+			handleEmulatorEvents();
 		}
 	};
 
+	if constexpr (runPerformanceProfiling)
+		performanceProfiling();
+
+	noCartridgeLoadedLoop();
 	long long lastTimeStamp = ggb::getCurrentTimeInNanoSeconds();
+	lastStatisticsTime = lastTimeStamp;
 	int stepCounter = 0;
-	noCartridgeLoadedLoop();
 
 	while (running)
 	{
@@ -185,25 +301,60 @@ void EmulatorThread::run()
 		if (stepCounter < UPDATE_AFTER_STEPS)
 			continue;
 
+		if (m_emulatorEventPending.load(std::memory_order_relaxed))
+		{
+			handleEmulatorEvents();
+			if (running && !m_emulator->isCartridgeLoaded())
+			{
+				// Neither the requested nor the previous ROM could be loaded, wait for the next one instead of stepping an empty emulator
+				noCartridgeLoadedLoop();
+				lastTimeStamp = ggb::getCurrentTimeInNanoSeconds();
+				stepCounter = 0;
+				continue;
+			}
+		}
+
 		if (m_gameRenderer->hasNewImage())
-			emit renderedImage(m_gameRenderer->getCurrentImage());
+		{
+			m_presentationFeedback.framesInFlight++;
+			const auto dirtyRows = m_gameRenderer->dirtyRows();
+			emit renderedImage(m_gameRenderer->getCurrentImage(), dirtyRows.top, dirtyRows.bottom);
+		}
+
+		if (!m_pendingFastBootSnapshot.empty() && (m_pendingFastBootPoint == FastBootPoint::AfterFrames)
+			&& (m_gameRenderer->frameCount() >= m_fastBootCaptureFrame))
+			captureFastBootSnapshot();
 
 		stepCounter = 0;
 		const auto currentTime = ggb::getCurrentTimeInNanoSeconds();
 		const auto timePast = currentTime - lastTimeStamp;
 		lastTimeStamp = currentTime;
+		probeFrameDeadline(currentTime);
 
 		maxSpeedupTimer.update(timePast);
 		inputTimer.update(timePast);
 		emulatorEventsTimer.update(timePast);
 	}
 
+	stopRecording();
 	saveCartridgeRAM();
 	saveCartridgeRTC();
+
+	const auto frameJitter = m_frameJitter.totalStatistics();
+	std::cout << "Scheduling jitter: " << frameJitter.deadlineMisses << " of " << frameJitter.samples << " frames missed their deadline (max "
+		<< frameJitter.maxLatenessInNanoSeconds / 1000000.0 << " ms late)";
+	if (m_audioHandler)
+	{
+		const auto audioJitter = m_audioHandler->callbackJitter().totalStatistics();
+		std::cout << ", " << audioJitter.deadlineMisses << " of " << audioJitter.samples << " audio callbacks were late (max "
+			<< audioJitter.maxLatenessInNanoSeconds / 1000000.0 << " ms)";
+	}
+	std::cout << std::endl;
 }
 
 void EmulatorThread::performanceProfiling()
 {
+	initializeSubsystems();
 	auto saveStatePath = std::filesystem::path(L"Savestates/Savestate1.bin");
 	m_emulator->loadEmulatorState(saveStatePath);
 	m_emulator->setEmulationSpeed(999);
@@ -211,8 +362,193 @@ void EmulatorThread::performanceProfiling()
 	m_gameRenderer->setFrameSkip(19);
 }
 
+void EmulatorThread::initializeSubsystems()
+{
+	const auto startTime = ggb::getCurrentTimeInNanoSeconds();
+	createEmulator();
+	m_audioHandler = std::make_unique<Audio>(m_emulator->getSampleBuffer(), m_audioThreadSettings);
+	m_inputHandler = std::make_unique<InputHandler>();
+
+	const auto initializationTimeInMilliSeconds = (ggb::getCurrentTimeInNanoSeconds() - startTime) / 1000000.0;
+	std::cout << "Emulator, audio and controller initialization took " << initializationTimeInMilliSeconds << " ms" << std::endl;
+}
+
+void EmulatorThread::createEmulator()
+{
+	m_emulator = std::make_unique<ggb::Emulator>();
+
+	auto gameWindowDimensions = m_emulator->getGameWindowDimensions();
+	m_tileDataRenderer = nullptr;
+	auto gameRenderer = std::make_unique<QTRenderer>(gameWindowDimensions.width, gameWindowDimensions.height, &m_presentationFeedback, &m_recorder);
+	m_gameRenderer = gameRenderer.get();
+
+	m_emulator->setGameRenderer(std::move(gameRenderer));
+}
+
+void EmulatorThread::updateTileDataRenderer()
+{
+	const bool enabled = m_tileDataSnapshots.enabled;
+	if (!enabled)
+		detachTileDataRenderer();
+	if (!enabled || m_tileDataRenderer)
+		return;
+
+	auto tileDataRenderer = std::make_unique<TileDataRenderer>(&m_tileDataSnapshots);
+	m_tileDataRenderer = tileDataRenderer.get();
+	m_emulator->setTileDataRenderer(std::move(tileDataRenderer));
+}
+
+void EmulatorThread::probeFrameDeadline(long long currentTime)
+{
+	static constexpr long long FRAME_INTERVAL = static_cast<long long>(1000000000 / GAMEBOY_FRAMES_PER_SECOND);
+
+	const auto frameCount = m_gameRenderer->frameCount();
+	if (frameCount == m_lastProbedFrame)
+		return;
+
+	// Only frames at 1x speed have a deadline, after a pause or a cartridge switch the measurement starts again
+	const bool realTime = !m_emulator->isPaused() && (m_emulator->emulationSpeed() == 1.0);
+	if (realTime && (m_probedRenderer == m_gameRenderer) && (m_lastProbedFrameTime != 0) && (frameCount == m_lastProbedFrame + 1))
+		m_frameJitter.addSample(FRAME_INTERVAL, currentTime - m_lastProbedFrameTime);
+
+	m_probedRenderer = m_gameRenderer;
+	m_lastProbedFrame = frameCount;
+	m_lastProbedFrameTime = realTime ? currentTime : 0;
+}
+
+void EmulatorThread::emitSchedulingJitter()
+{
+	const auto frameJitter = m_frameJitter.takeStatistics();
+	const auto audioJitter = m_audioHandler->callbackJitter().takeStatistics();
+	if (const auto description = m_audioHandler->takeThreadSettingsDescription())
+		std::cout << *description << std::endl;
+	emit schedulingJitter(frameJitter.deadlineMisses, frameJitter.maxLatenessInNanoSeconds / 1000000.0,
+		audioJitter.deadlineMisses, audioJitter.maxLatenessInNanoSeconds / 1000000.0);
+}
+
+void EmulatorThread::updateRecording()
+{
+	const bool recordingRequested = m_recordingRequested;
+	if (recordingRequested == m_recorder.isRecording())
+		return;
+
+	// The previous recording is still written in the background, try again on the next update
+	if (recordingRequested && m_recorder.isRunning())
+		return;
+
+	if (!recordingRequested)
+	{
+		stopRecording();
+		return;
+	}
+
+	std::stringstream fileName;
+	const auto now = std::time(nullptr);
+	fileName << getCartridgeName() << "_" << std::put_time(std::localtime(&now), "%Y%m%d_%H%M%S");
+
+	const auto dimensions = m_emulator->getGameWindowDimensions();
+	const auto error = m_recorder.startRecording(RECORDING_BASE_PATH / fileName.str(), dimensions.width, dimensions.height, GAMEBOY_FRAMES_PER_SECOND);
+	if (!error.empty())
+	{
+		m_recordingRequested = false;
+		emit warning(QString::fromStdString(error));
+		emit recordingStatus(QString(), false);
+		return;
+	}
+
+	m_audioHandler->setRecorder(&m_recorder);
+	emit recordingStatus(recordingStatusText(true), true);
+}
+
+void EmulatorThread::stopRecording()
+{
+	if (!m_recorder.isRecording())
+		return;
+
+	// The audio thread must not push anymore while the recorder finishes its files
+	if (m_audioHandler)
+		m_audioHandler->setRecorder(nullptr);
+	// Does not wait for the writer, recordingFinished() reports the result
+	m_recorder.stopRecording();
+	emit recordingStatus("Recording stopped, writing the remaining frames", false);
+}
+
+void EmulatorThread::recordingFinished()
+{
+	if (m_recorder.isRecording())
+		return;
+
+	const auto statistics = m_recorder.statistics();
+	std::cout << "Recording stopped: " << statistics.writtenVideoFrames << " video frames written (" << statistics.droppedVideoFrames
+		<< " dropped), " << statistics.writtenAudioFrames << " audio frames written (" << statistics.droppedAudioFrames << " dropped)" << std::endl;
+	emit recordingStatus(recordingStatusText(false), false);
+}
+
+QString EmulatorThread::recordingStatusText(bool recording) const
+{
+	const auto statistics = m_recorder.statistics();
+	return QString("%1: %2 frames written, %3 frames / %4 audio samples dropped")
+		.arg(recording ? "Recording" : "Recording stopped")
+		.arg(statistics.writtenVideoFrames)
+		.arg(statistics.droppedVideoFrames)
+		.arg(statistics.droppedAudioFrames);
+}
+
+void EmulatorThread::detachTileDataRenderer()
+{
+	if (!m_tileDataRenderer)
+		return;
+
+	m_emulator->setTileDataRenderer(nullptr);
+	m_tileDataRenderer = nullptr;
+}
+
+EmulatorThread::CachedCartridge EmulatorThread::takeActiveCartridge()
+{
+	// Cached emulators do not need the tile data, the next active one gets a renderer while the viewer is open
+	detachTileDataRenderer();
+
+	CachedCartridge cartridge = {};
+	cartridge.path = normalizedRomPath(m_emulator->getLoadedCartridgePath());
+	cartridge.romWriteTime = romWriteTime(cartridge.path);
+	cartridge.emulator = std::move(m_emulator);
+	cartridge.renderer = m_gameRenderer;
+	m_gameRenderer = nullptr;
+
+	return cartridge;
+}
+
+bool EmulatorThread::activateCachedCartridge(const std::filesystem::path& path)
+{
+	const auto key = normalizedRomPath(path);
+	auto it = std::find_if(m_cartridgeCache.begin(), m_cartridgeCache.end(), [&key](const CachedCartridge& cartridge)
+	{
+		return cartridge.path == key;
+	});
+	if (it == m_cartridgeCache.end())
+		return false;
+
+	if (it->romWriteTime != romWriteTime(key))
+	{
+		// The ROM was rebuilt / replaced, the cached cartridge is outdated
+		m_cartridgeCache.erase(it);
+		return false;
+	}
+
+	m_emulator = std::move(it->emulator);
+	m_gameRenderer = it->renderer;
+	m_cartridgeCache.erase(it);
+	// The RTC of a cached cartridge stood still, the file written when it was switched away lets it catch up to the real time
+	loadRTC();
+
+	return true;
+}
+
 std::string EmulatorThread::getCartridgeName()
 {
+	if (!m_emulator)
+		return {};
+
 	auto loadedPath = m_emulator->getLoadedCartridgePath();
 	if (loadedPath.empty())
 		return {};
@@ -227,16 +563,16 @@ std::string EmulatorThread::getCartridgeName()
 	return gameName;
 }
 
-void EmulatorThread::loadRAM()
+std::filesystem::path EmulatorThread::loadRAM()
 {
 	auto gameName = getCartridgeName();
 	if (gameName.empty())
-		return;
+		return {};
 
 	std::filesystem::path path = CARTRIDGE_DATA_BASE_PATH;
 	auto paths = getFilePaths(CARTRIDGE_DATA_BASE_PATH, gameName + RAM_FILE_SUFFIX);
 	if (paths.empty())
-		return;
+		return {};
 
 	const auto& pathToLoad = paths.front().first;
 	try
@@ -248,19 +584,22 @@ void EmulatorThread::loadRAM()
 		auto pathString = QString::fromStdString(pathToLoad.u8string());
 		auto errorStr = QString::fromUtf8(e.what());
 		emit warning(QString("Unable to load ram '%1' \n %2").arg(pathString, errorStr));
+		return {};
 	}
+
+	return pathToLoad;
 }
 
-void EmulatorThread::loadRTC()
+bool EmulatorThread::loadRTC()
 {
 	auto gameName = getCartridgeName();
 	if (gameName.empty())
-		return;
+		return false;
 
 	std::filesystem::path path = CARTRIDGE_DATA_BASE_PATH;
 	auto paths = getFilePaths(CARTRIDGE_DATA_BASE_PATH, gameName + RTC_FILE_SUFFIX);
 	if (paths.empty())
-		return;
+		return false;
 	const auto& pathToLoad = paths.front().first;
 
 	try
@@ -272,14 +611,88 @@ void EmulatorThread::loadRTC()
 		auto pathString = QString::fromStdString(pathToLoad.u8string());
 		auto errorStr = QString::fromUtf8(e.what());
 		emit warning(QString("Unable to load real time clock '%1' \n %2").arg(pathString, errorStr));
+		return false;
 	}
+
+	return true;
 }
 
-void EmulatorThread::loadROM(const std::filesystem::path& path)
+void EmulatorThread::loadROM(const std::filesystem::path& path, long long requestTime)
 {
+	if (!m_emulator)
+		initializeSubsystems();
+
+	const auto startTime = ggb::getCurrentTimeInNanoSeconds();
+	const auto emulationSpeed = m_emulator->emulationSpeed();
+	m_pendingFastBootSnapshot.clear();
+
 	saveCartridgeRAM();
 	saveCartridgeRTC();
 
+	// Loading the same ROM again always starts it from scratch, otherwise the previous cartridge is kept warm
+	const bool switchCartridge = m_emulator->isCartridgeLoaded() && (normalizedRomPath(m_emulator->getLoadedCartridgePath()) != normalizedRomPath(path));
+	bool loadedFromCache = false;
+	bool restoredFastBoot = false;
+	if (switchCartridge)
+	{
+		auto previousCartridge = takeActiveCartridge();
+		loadedFromCache = activateCachedCartridge(path);
+		if (!loadedFromCache)
+			createEmulator();
+
+		m_cartridgeCache.emplace_front(std::move(previousCartridge));
+		while (m_cartridgeCache.size() > CARTRIDGE_CACHE_SIZE)
+			m_cartridgeCache.pop_back();
+	}
+
+	if (!loadedFromCache)
+	{
+		try
+		{
+			m_emulator->loadCartridge(path);
+		}
+		catch (const std::exception& e)
+		{
+			auto pathString = QString::fromStdString(path.u8string());
+			auto errorStr = QString::fromUtf8(e.what());
+			emit warning(QString("Unable to load '%1' \n %2").arg(pathString, errorStr));
+		}
+
+		if (switchCartridge && !m_emulator->isCartridgeLoaded())
+		{
+			// Keep playing the previous game instead of ending up with an empty emulator.
+			// If its cache entry became outdated in the meantime, it is loaded again from its ROM and save files
+			const auto previousPath = m_cartridgeCache.front().path;
+			if (!activateCachedCartridge(previousPath))
+				reloadCartridge(previousPath);
+		}
+		else
+		{
+			const auto loadedRAMPath = loadRAM();
+			// The RTC keeps running while the game is not played, restoring an old snapshot would reset it
+			const bool loadedRTC = loadRTC();
+			if (m_fastBootEnabled && !loadedRTC)
+				restoredFastBoot = prepareFastBoot(loadedRAMPath);
+		}
+	}
+
+	m_emulator->setEmulationSpeed(emulationSpeed);
+	m_audioHandler->setSampleBuffer(m_emulator->getSampleBuffer());
+	m_gameRenderer->forceFullUpdate();
+	m_audioHandler->setAudioPlaying(!m_emulator->isPaused() && (emulationSpeed == 1.0));
+
+	const auto endTime = ggb::getCurrentTimeInNanoSeconds();
+	const auto loadTimeInMilliSeconds = (endTime - startTime) / 1000000.0;
+	std::cout << "ROM switch to '" << path.u8string() << "' took " << loadTimeInMilliSeconds << " ms ("
+		<< (loadedFromCache ? "cached" : (restoredFastBoot ? "fast boot" : "cold")) << ")";
+	if (requestTime != 0)
+		std::cout << ", " << (endTime - requestTime) / 1000000.0 << " ms after it was requested";
+	std::cout << std::endl;
+}
+
+void EmulatorThread::reloadCartridge(const std::filesystem::path& path)
+{
+	createEmulator();
 	try
 	{
 		m_emulator->loadCartridge(path);
@@ -288,13 +701,84 @@ void EmulatorThread::loadROM(const std::filesystem::path& path)
 	{
 		auto pathString = QString::fromStdString(path.u8string());
 		auto errorStr = QString::fromUtf8(e.what());
-		emit warning(QString("Unable to load '%1' \n %2").arg(pathString, errorStr));
+		emit warning(QString("Unable to reload the previous ROM '%1' \n %2").arg(pathString, errorStr));
+		return;
 	}
 
 	loadRAM();
 	loadRTC();
 }
 
+bool EmulatorThread::prepareFastBoot(const std::filesystem::path& loadedRAMPath)
+{
+	if (!isFastBootAvailable() || !m_emulator->isCartridgeLoaded())
+		return false;
+
+	// Snapshots contain the cartridge RAM, so they are only valid as long as the save file they were taken with
+	const auto romCRC = calculateFileCRC(m_emulator->getLoadedCartridgePath());
+	const auto ramKey = loadedRAMPath.empty() ? std::string("NORAM") : toHexString(calculateFileCRC(loadedRAMPath));
+	// A snapshot taken at another point does not match the current settings, changing them takes a new one
+	const auto pointKey = (m_fastBootPoint == FastBootPoint::FirstInput) ? std::string("INPUT") : ("F" + std::to_string(std::max(0, m_fastBootFrame.load())));
+	const auto snapshotPath = FAST_BOOT_BASE_PATH / (toHexString(romCRC) + "_" + GGBOY_CORE_VERSION + "_" + ramKey + "_" + pointKey + SAVESTATE_FILE_ENDING);
+
+	if (std::filesystem::exists(snapshotPath))
+	{
+		if (m_emulator->loadEmulatorState(snapshotPath))
+			return true;
+		emit warning(QString("Unable to load fast boot snapshot '%1'").arg(QString::fromStdString(snapshotPath.u8string())));
+	}
+
+	m_pendingFastBootSnapshot = snapshotPath;
+	m_pendingFastBootPoint = m_fastBootPoint;
+	m_fastBootCaptureFrame = m_gameRenderer->frameCount() + static_cast<uint64_t>(std::max(0, m_fastBootFrame.load()));
+
+	return false;
+}
+
+void EmulatorThread::captureFastBootSnapshot()
+{
+	const auto snapshotPath = std::move(m_pendingFastBootSnapshot);
+	m_pendingFastBootSnapshot.clear();
+
+	try
+	{
+		if (!std::filesystem::exists(FAST_BOOT_BASE_PATH))
+			std::filesystem::create_directories(FAST_BOOT_BASE_PATH);
+	}
+	catch (const std::exception& e)
+	{
+		emit warning(QString("Unable to save fast boot snapshot: %1").arg(e.what()));
+		return;
+	}
+
+	if (!m_emulator->saveEmulatorState(snapshotPath))
+	{
+		emit warning(QString("Unable to save fast boot snapshot '%1'").arg(QString::fromStdString(snapshotPath.u8string())));
+		return;
+	}
+	removeSupersededSnapshots(snapshotPath);
+}
+
+void EmulatorThread::removeSupersededSnapshots(const std::filesystem::path& snapshotPath)
+{
+	// Snapshot names start with the ROM CRC followed by '_'
+	const auto fileName = snapshotPath.filename().u8string();
+	const auto romPrefix = fileName.substr(0, fileName.find('_') + 1);
+
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator(FAST_BOOT_BASE_PATH, ec))
+	{
+		const auto entryName = entry.path().filename().u8string();
+		if ((entryName == fileName) || (entryName.rfind(romPrefix, 0) != 0))
+			continue;
+
+		std::error_code removeError;
+		std::filesystem::remove(entry.path(), removeError);
+		if (removeError)
+			fprintf(stderr, "Unable to remove old fast boot snapshot '%s': %s\n", entryName.c_str(), removeError.message().c_str());
+	}
+}
+
 void EmulatorThread::saveCartridgeRAM()
 {
 	auto pathToWrite = getFileSavePath(RAM_FILE_SUFFIX, RAM_FILE_ENDING);
@@ -386,7 +870,23 @@ void EmulatorThread::updateInput()
 	}
 
 	m_inputHandler->update(m_keyStates);
-	m_emulator->setInputState(m_inputHandler->getCurrentState());
+	const auto input = m_inputHandler->getCurrentState();
+	if (!m_pendingFastBootSnapshot.empty() && isAnyButtonPressed(input))
+	{
+		// A snapshot after user input would no longer be the state every launch starts in
+		if (m_pendingFastBootPoint == FastBootPoint::FirstInput)
+			captureFastBootSnapshot();
+		else
+			m_pendingFastBootSnapshot.clear();
+	}
+	m_emulator->setInputState(input);
+}
+
+void EmulatorThread::applyFastForwardSpeed()
+{
+	const auto speed = m_emulator->emulationSpeed();
+	if ((speed != 1.0) && (speed != m_fastForwardSpeed))
+		m_emulator->setEmulationSpeed(m_fastForwardSpeed);
 }
 
 void EmulatorThread::handleEmulatorKeyPress(int key)
@@ -420,6 +920,9 @@ void EmulatorThread::handleEmulatorKeyPress(int key)
 			emit warning(QString("Unable to load savestate%1").arg(number));
 	};
 
+	if ((key == Qt::Key::Key_R) || ((key >= Qt::Key::Key_F5) && (key <= Qt::Key::Key_F8)))
+		m_pendingFastBootSnapshot.clear();
+
 	if (key == Qt::Key::Key_R)
 		m_emulator->reset();
 	if (key == Qt::Key::Key_F1)
@@ -450,7 +953,7 @@ void EmulatorThread::handleEmulatorKeyPress(int key)
 	{
 		if (m_emulator->emulationSpeed() == 1.0)
 		{
-			m_emulator->setEmulationSpeed(5.0);
+			m_emulator->setEmulationSpeed(m_fastForwardSpeed);
 			m_audioHandler->setAudioPlaying(false);
 		}
 		else
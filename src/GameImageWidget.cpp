@@ -0,0 +1,55 @@
+#include "GameImageWidget.hpp"
+
+#include <QPainter>
+#include <QPaintEvent>
+
+GameImageWidget::GameImageWidget(QWidget* parent)
+	: QWidget(parent)
+{
+	setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+	// Every repainted pixel is covered by the pixmap, Qt does not need to clear the background first
+	setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void GameImageWidget::updateImage(const QImage& image, int dirtyTop, int dirtyBottom)
+{
+	const auto scaledSize = image.size() * SCALE;
+	if (m_pixmap.size() != scaledSize)
+	{
+		m_pixmap = QPixmap::fromImage(image.scaled(scaledSize));
+		updateGeometry();
+		update();
+		return;
+	}
+	if (dirtyBottom < dirtyTop)
+		return;
+
+	const int rows = dirtyBottom - dirtyTop + 1;
+	const QRect dirtyBand(0, dirtyTop * SCALE, scaledSize.width(), rows * SCALE);
+	{
+		QPainter painter(&m_pixmap);
+		painter.drawImage(dirtyBand, image, QRect(0, dirtyTop, image.width(), rows));
+	}
+	update(dirtyBand);
+}
+
+QSize GameImageWidget::sizeHint() const
+{
+	return m_pixmap.size();
+}
+
+QSize GameImageWidget::minimumSizeHint() const
+{
+	return m_pixmap.size();
+}
+
+void GameImageWidget::paintEvent(QPaintEvent* event)
+{
+	QPainter painter(this);
+	if (m_pixmap.isNull())
+	{
+		painter.fillRect(event->rect(), palette().window());
+		return;
+	}
+	painter.drawPixmap(event->rect(), m_pixmap, event->rect());
+}
@@ -0,0 +1,304 @@
+#include "GameplayRecorder.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+
+static constexpr int BYTES_PER_PIXEL = 3;
+// Audio which lags behind the video by more than this is padded with silence, normal playback stays far below it
+static constexpr uint64_t AUDIO_SYNC_TOLERANCE = ggb::STANDARD_SAMPLE_RATE / 4;
+static constexpr unsigned long WRITER_IDLE_SLEEP_MS = 2;
+// The queues hold about 2 seconds of video, writing them normally takes far less. Only a stuck disk hits this deadline
+static constexpr unsigned long SHUTDOWN_DRAIN_TIMEOUT_MS = 5000;
+// Frames which follow the previous one faster than this fraction of a frame interval (fast forward) are not recorded,
+// the recording shows what was played in real time
+static constexpr double MIN_FRAME_DISTANCE = 0.5;
+static constexpr double NANOSECONDS_PER_SECOND = 1000000000.0;
+static constexpr double NANOSECONDS_PER_MILLISECOND = 1000000.0;
+
+template <typename T>
+static void writeLittleEndian(std::ofstream& stream, T value)
+{
+	for (size_t i = 0; i < sizeof(T); i++)
+		stream.put(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF));
+}
+
+GameplayRecorder::GameplayRecorder(QObject* parent)
+	: QThread(parent)
+{
+}
+
+GameplayRecorder::~GameplayRecorder()
+{
+	stopRecording();
+	if (wait(SHUTDOWN_DRAIN_TIMEOUT_MS))
+		return;
+
+	fprintf(stderr, "Recording could not be finished within %lu ms, discarding the remaining frames\n", SHUTDOWN_DRAIN_TIMEOUT_MS);
+	m_discardQueued = true;
+	wait();
+}
+
+std::string GameplayRecorder::startRecording(const std::filesystem::path& basePath, int width, int height, double framesPerSecond)
+{
+	if (isRecording())
+		return "Already recording";
+	if (isRunning())
+		return "The previous recording is still being written";
+
+	std::error_code error;
+	if (basePath.has_parent_path())
+		std::filesystem::create_directories(basePath.parent_path(), error);
+
+	auto videoPath = basePath;
+	auto timestampPath = basePath;
+	auto audioPath = basePath;
+	auto infoPath = basePath;
+	videoPath += ".rgb";
+	timestampPath += ".timestamps.txt";
+	audioPath += ".wav";
+	infoPath += ".txt";
+
+	m_videoFile = std::ofstream(videoPath, std::ios::binary | std::ios::trunc);
+	m_timestampFile = std::ofstream(timestampPath, std::ios::trunc);
+	m_audioFile = std::ofstream(audioPath, std::ios::binary | std::ios::trunc);
+	if (!m_videoFile || !m_timestampFile || !m_audioFile)
+	{
+		m_videoFile.close();
+		m_timestampFile.close();
+		m_audioFile.close();
+		return "Unable to create recording files at: " + basePath.string();
+	}
+
+	m_width = width;
+	m_height = height;
+	m_framesPerSecond = framesPerSecond;
+	const auto frameSize = static_cast<size_t>(width) * height * BYTES_PER_PIXEL;
+	for (auto& frame : m_videoQueue.storage())
+		frame.pixels.resize(frameSize);
+	m_videoQueue.clear();
+	m_audioQueue.clear();
+	m_discardQueued = false;
+	m_startTime = ggb::getCurrentTimeInNanoSeconds();
+	m_lastPushedTimestamp = -1;
+	m_lastWrittenTimestamp = 0;
+	m_pendingDroppedAudioFrames = 0;
+	m_writtenVideoFrames = 0;
+	m_droppedVideoFrames = 0;
+	m_writtenAudioFrames = 0;
+	m_droppedAudioFrames = 0;
+	writeWavHeader(0);
+	m_timestampFile << "# timestamp format v2" << std::endl;
+	m_timestampFile << std::fixed << std::setprecision(3);
+
+	const auto videoOnlyName = basePath.filename().string() + ".video.mkv";
+	std::ofstream infoFile(infoPath, std::ios::trunc);
+	infoFile << "Raw video: rgb24, " << width << "x" << height << ", variable frame rate (up to " << framesPerSecond
+		<< " frames per second), the presentation time of every frame in milliseconds is stored in \""
+		<< timestampPath.filename().string() << "\"" << std::endl;
+	infoFile << "Dropped frames are not part of the video, the previous frame stays visible until the next timestamp" << std::endl;
+	infoFile << "Convert with: ffmpeg -f rawvideo -pixel_format rgb24 -video_size " << width << "x" << height
+		<< " -framerate " << framesPerSecond << " -i \"" << videoPath.filename().string()
+		<< "\" -c:v libx264rgb -crf 0 \"" << videoOnlyName << "\"" << std::endl;
+	infoFile << "Then: mkvmerge -o \"" << basePath.filename().string() << ".mkv\" --timestamps 0:\""
+		<< timestampPath.filename().string() << "\" \"" << videoOnlyName << "\" \"" << audioPath.filename().string()
+		<< "\"" << std::endl;
+
+	m_recording = true;
+	start(QThread::LowPriority);
+	return "";
+}
+
+void GameplayRecorder::stopRecording()
+{
+	if (!isRecording())
+		return;
+
+	m_recording = false;
+	requestInterruption();
+}
+
+bool GameplayRecorder::isRecording() const
+{
+	return m_recording;
+}
+
+GameplayRecorder::Statistics GameplayRecorder::statistics() const
+{
+	Statistics statistics = {};
+	statistics.writtenVideoFrames = m_writtenVideoFrames;
+	statistics.droppedVideoFrames = m_droppedVideoFrames;
+	statistics.writtenAudioFrames = m_writtenAudioFrames;
+	statistics.droppedAudioFrames = m_droppedAudioFrames;
+	return statistics;
+}
+
+void GameplayRecorder::pushVideoFrame(const ggb::FrameBuffer& framebuffer)
+{
+	if (!m_recording)
+		return;
+
+	const auto timestamp = ggb::getCurrentTimeInNanoSeconds() - m_startTime;
+	const auto minFrameDistance = static_cast<long long>(MIN_FRAME_DISTANCE * NANOSECONDS_PER_SECOND / m_framesPerSecond);
+	if (m_lastPushedTimestamp >= 0 && timestamp - m_lastPushedTimestamp < minFrameDistance)
+		return;
+
+	m_lastPushedTimestamp = timestamp;
+	auto frame = m_videoQueue.acquireWriteSlot();
+	if (!frame)
+	{
+		m_droppedVideoFrames++;
+		return;
+	}
+
+	const auto width = std::min(framebuffer.width(), static_cast<size_t>(m_width));
+	const auto height = std::min(framebuffer.height(), static_cast<size_t>(m_height));
+	for (size_t y = 0; y < height; y++)
+	{
+		auto pixel = frame->pixels.data() + y * m_width * BYTES_PER_PIXEL;
+		for (size_t x = 0; x < width; x++)
+		{
+			const auto& ggbColor = framebuffer.getPixel(x, y);
+			*pixel++ = ggbColor.r;
+			*pixel++ = ggbColor.g;
+			*pixel++ = ggbColor.b;
+		}
+	}
+	frame->timestamp = timestamp;
+	m_videoQueue.commitWrite();
+}
+
+void GameplayRecorder::pushAudio(const ggb::AUDIO_FORMAT* samples, size_t frameCount)
+{
+	if (!m_recording)
+		return;
+
+	while (frameCount > 0)
+	{
+		const auto chunkFrames = std::min(frameCount, AUDIO_CHUNK_FRAMES);
+		auto chunk = m_audioQueue.acquireWriteSlot();
+		if (!chunk)
+		{
+			m_pendingDroppedAudioFrames += chunkFrames;
+			m_droppedAudioFrames += chunkFrames;
+		}
+		else
+		{
+			std::memcpy(chunk->samples.data(), samples, chunkFrames * CHANNEL_COUNT * sizeof(ggb::AUDIO_FORMAT));
+			chunk->frameCount = chunkFrames;
+			chunk->droppedBefore = m_pendingDroppedAudioFrames;
+			m_pendingDroppedAudioFrames = 0;
+			m_audioQueue.commitWrite();
+		}
+		samples += chunkFrames * CHANNEL_COUNT;
+		frameCount -= chunkFrames;
+	}
+}
+
+void GameplayRecorder::run()
+{
+	while (!isInterruptionRequested())
+	{
+		const bool wroteVideo = writeVideo();
+		const bool wroteAudio = writeAudio();
+		if (!wroteVideo && !wroteAudio)
+			msleep(WRITER_IDLE_SLEEP_MS);
+	}
+
+	// The producers stopped pushing, what is still queued is bounded by the queue sizes
+	if (!m_discardQueued)
+	{
+		writeVideo();
+		writeAudio();
+	}
+	synchronizeAudio();
+	writeWavHeader(m_writtenAudioFrames);
+	m_videoFile.close();
+	m_timestampFile.close();
+	m_audioFile.close();
+}
+
+bool GameplayRecorder::writeVideo()
+{
+	bool wroteFrame = false;
+	while (!m_discardQueued)
+	{
+		auto frame = m_videoQueue.acquireReadSlot();
+		if (!frame)
+			break;
+
+		m_videoFile.write(reinterpret_cast<const char*>(frame->pixels.data()), static_cast<std::streamsize>(frame->pixels.size()));
+		m_timestampFile << frame->timestamp / NANOSECONDS_PER_MILLISECOND << '\n';
+		m_lastWrittenTimestamp = frame->timestamp;
+		m_writtenVideoFrames++;
+		m_videoQueue.commitRead();
+		wroteFrame = true;
+	}
+
+	return wroteFrame;
+}
+
+bool GameplayRecorder::writeAudio()
+{
+	bool wroteAudio = false;
+	while (!m_discardQueued)
+	{
+		auto chunk = m_audioQueue.acquireReadSlot();
+		if (!chunk)
+			break;
+
+		writeSilence(chunk->droppedBefore);
+		m_audioFile.write(reinterpret_cast<const char*>(chunk->samples.data()), chunk->frameCount * CHANNEL_COUNT * sizeof(ggb::AUDIO_FORMAT));
+		m_writtenAudioFrames += chunk->frameCount;
+		m_audioQueue.commitRead();
+		wroteAudio = true;
+	}
+	if (wroteAudio)
+		synchronizeAudio();
+
+	return wroteAudio;
+}
+
+void GameplayRecorder::synchronizeAudio()
+{
+	// The video timestamps are real time, so the padding is bounded by the recorded duration
+	const auto expectedAudioFrames = static_cast<uint64_t>(m_lastWrittenTimestamp * ggb::STANDARD_SAMPLE_RATE / NANOSECONDS_PER_SECOND);
+	if (expectedAudioFrames > m_writtenAudioFrames + AUDIO_SYNC_TOLERANCE)
+		writeSilence(expectedAudioFrames - m_writtenAudioFrames);
+}
+
+void GameplayRecorder::writeSilence(uint64_t frameCount)
+{
+	const size_t frameSize = CHANNEL_COUNT * sizeof(ggb::AUDIO_FORMAT);
+	m_silence.resize(AUDIO_CHUNK_FRAMES * frameSize, 0);
+	m_writtenAudioFrames += frameCount;
+	while (frameCount > 0)
+	{
+		const auto frames = std::min<uint64_t>(frameCount, AUDIO_CHUNK_FRAMES);
+		m_audioFile.write(m_silence.data(), frames * frameSize);
+		frameCount -= frames;
+	}
+}
+
+void GameplayRecorder::writeWavHeader(uint64_t audioFrames)
+{
+	const uint32_t bitsPerSample = sizeof(ggb::AUDIO_FORMAT) * 8;
+	const uint32_t blockAlign = CHANNEL_COUNT * sizeof(ggb::AUDIO_FORMAT);
+	const uint32_t dataSize = static_cast<uint32_t>(std::min<uint64_t>(audioFrames * blockAlign, UINT32_MAX - 36));
+
+	m_audioFile.seekp(0);
+	m_audioFile.write("RIFF", 4);
+	writeLittleEndian<uint32_t>(m_audioFile, 36 + dataSize);
+	m_audioFile.write("WAVEfmt ", 8);
+	writeLittleEndian<uint32_t>(m_audioFile, 16);
+	writeLittleEndian<uint16_t>(m_audioFile, 1); // PCM
+	writeLittleEndian<uint16_t>(m_audioFile, CHANNEL_COUNT);
+	writeLittleEndian<uint32_t>(m_audioFile, ggb::STANDARD_SAMPLE_RATE);
+	writeLittleEndian<uint32_t>(m_audioFile, ggb::STANDARD_SAMPLE_RATE * blockAlign);
+	writeLittleEndian<uint16_t>(m_audioFile, blockAlign);
+	writeLittleEndian<uint16_t>(m_audioFile, bitsPerSample);
+	m_audioFile.write("data", 4);
+	writeLittleEndian<uint32_t>(m_audioFile, dataSize);
+	m_audioFile.seekp(0, std::ios::end);
+}
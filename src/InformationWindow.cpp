@@ -29,6 +29,27 @@ void InformationWindow::addSpeedup(double speedUp)
 	m_currentIndex++;
 }
 
+void InformationWindow::setCurrentSpeed(double speed)
+{
+	m_ui->emulationSpeedLineEdit->setText(QString::number(speed, 'f', 2) + "x");
+}
+
+void InformationWindow::addFrameStatistics(qulonglong presentedFrames, qulonglong skippedFrames, qulonglong unchangedFrames)
+{
+	m_unchangedFrames += unchangedFrames;
+	m_ui->presentedFramesLineEdit->setText(QString::number(presentedFrames));
+	m_ui->skippedFramesLineEdit->setText(QString::number(skippedFrames));
+	m_ui->unchangedFramesLineEdit->setText(QString("%1 (%2/s)").arg(m_unchangedFrames).arg(unchangedFrames));
+}
+
+void InformationWindow::addSchedulingJitter(qulonglong missedFrameDeadlines, double maxFrameLatenessInMs, qulonglong lateAudioCallbacks, double maxAudioLatenessInMs)
+{
+	m_missedFrameDeadlines += missedFrameDeadlines;
+	m_lateAudioCallbacks += lateAudioCallbacks;
+	m_ui->missedFrameDeadlinesLineEdit->setText(QString("%1 (%2/s, max %3 ms)").arg(m_missedFrameDeadlines).arg(missedFrameDeadlines).arg(maxFrameLatenessInMs, 0, 'f', 1));
+	m_ui->lateAudioCallbacksLineEdit->setText(QString("%1 (%2/s, max %3 ms)").arg(m_lateAudioCallbacks).arg(lateAudioCallbacks).arg(maxAudioLatenessInMs, 0, 'f', 1));
+}
+
 void InformationWindow::updateInformations()
 {
 	double average = 0.0;
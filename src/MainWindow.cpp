@@ -1,22 +1,61 @@
 #include "MainWindow.hpp"
 
-MainWindow::MainWindow() : QMainWindow(nullptr), m_ui(new Ui::MainWindow)
+#include <QScreen>
+
+static const std::filesystem::path GAMES_BASE_PATH = "Roms/Games/";
+static const std::filesystem::path ROM_LIBRARY_CACHE_PATH = "Roms/Library.cache";
+
+MainWindow::MainWindow(QElapsedTimer startupTimer, ThreadSettings emulatorThreadSettings, ThreadSettings audioThreadSettings, int fastBootFrame)
+	: QMainWindow(nullptr)
+	, m_ui(new Ui::MainWindow)
+	, m_startupTimer(startupTimer)
+	, m_fastBootFrame(fastBootFrame)
 {
 	m_ui->setupUi(this);
 	m_emulatorThread = new EmulatorThread(this);
+	m_emulatorThread->setThreadSettings(emulatorThreadSettings, audioThreadSettings);
 	m_informationWindow = std::make_unique<InformationWindow>(this);
 	m_informationWindow->hide();
+	m_romLibrary = new RomLibrary(GAMES_BASE_PATH, ROM_LIBRARY_CACHE_PATH, this);
+	m_romLibraryWindow = std::make_unique<RomLibraryWindow>(m_romLibrary, this);
+	m_romLibraryWindow->hide();
+	m_tileDataWindow = std::make_unique<TileDataWindow>(m_emulatorThread->tileDataSnapshots(), this);
+	m_tileDataWindow->hide();
 
 	connect(m_ui->actionOpenROM, &QAction::triggered, this, &MainWindow::openROM);
 	connect(m_ui->actionInformations, &QAction::triggered, this, &MainWindow::toggleInformationWindow);
+	connect(m_ui->actionRomLibrary, &QAction::triggered, this, &MainWindow::toggleRomLibraryWindow);
+	connect(m_ui->actionTileDataViewer, &QAction::triggered, this, &MainWindow::toggleTileDataWindow);
+	connect(m_ui->actionRecordGameplay, &QAction::toggled, m_emulatorThread, &EmulatorThread::setRecording);
+	connect(m_romLibraryWindow.get(), &RomLibraryWindow::romSelected, this, &MainWindow::loadROM);
+	auto fastForwardSpeeds = new QActionGroup(this);
+	fastForwardSpeeds->addAction(m_ui->actionSpeed2x)->setData(2.0);
+	fastForwardSpeeds->addAction(m_ui->actionSpeed5x)->setData(5.0);
+	fastForwardSpeeds->addAction(m_ui->actionSpeed10x)->setData(10.0);
+	fastForwardSpeeds->addAction(m_ui->actionSpeedUncapped)->setData(EmulatorThread::UNCAPPED_SPEED);
+	connect(fastForwardSpeeds, &QActionGroup::triggered, this, &MainWindow::fastForwardSpeedSelected);
+	if (!EmulatorThread::isFastBootAvailable())
+	{
+		// Snapshots of an unknown core version could be loaded into a different core
+		m_ui->actionFastBoot->setEnabled(false);
+		m_ui->actionFastBoot->setText("Fast boot (unknown core version)");
+		m_ui->actionFastBootAtFirstInput->setEnabled(false);
+	}
+	connect(m_ui->actionFastBoot, &QAction::toggled, this, &MainWindow::updateFastBoot);
+	connect(m_ui->actionFastBootAtFirstInput, &QAction::toggled, this, &MainWindow::updateFastBoot);
 	connect(m_emulatorThread, &EmulatorThread::renderedImage, this, &MainWindow::updateImage);
 	connect(m_emulatorThread, &EmulatorThread::currentMaxSpeedup, this, &MainWindow::currentMaxSpeedup);
+	connect(m_emulatorThread, &EmulatorThread::currentSpeed, this, &MainWindow::currentSpeed);
+	connect(m_emulatorThread, &EmulatorThread::frameStatistics, this, &MainWindow::frameStatistics);
+	connect(m_emulatorThread, &EmulatorThread::schedulingJitter, this, &MainWindow::schedulingJitter);
 	connect(m_emulatorThread, &EmulatorThread::warning, this, &MainWindow::warning);
+	connect(m_emulatorThread, &EmulatorThread::recordingStatus, this, &MainWindow::recordingStatus);
 	m_emulatorThread->start();
 }
 
 MainWindow::~MainWindow()
 {
+	m_romLibrary->setThumbnail(m_currentROM, m_lastImage);
 	m_emulatorThread->quit();
 	m_emulatorThread->wait();
 }
@@ -26,11 +65,33 @@ void MainWindow::currentMaxSpeedup(double speedUp)
 	m_informationWindow->addSpeedup(speedUp);
 }
 
-void MainWindow::updateImage(QImage image)
+void MainWindow::currentSpeed(double speed)
+{
+	m_informationWindow->setCurrentSpeed(speed);
+}
+
+void MainWindow::frameStatistics(qulonglong presentedFrames, qulonglong skippedFrames, qulonglong unchangedFrames)
+{
+	m_informationWindow->addFrameStatistics(presentedFrames, skippedFrames, unchangedFrames);
+}
+
+void MainWindow::schedulingJitter(qulonglong missedFrameDeadlines, double maxFrameLatenessInMs, qulonglong lateAudioCallbacks, double maxAudioLatenessInMs)
+{
+	m_informationWindow->addSchedulingJitter(missedFrameDeadlines, maxFrameLatenessInMs, lateAudioCallbacks, maxAudioLatenessInMs);
+}
+
+void MainWindow::updateImage(QImage image, int dirtyTop, int dirtyBottom)
 {
-	auto upscaled = image.scaled(image.size() * 5);
-	auto buf = QPixmap::fromImage(upscaled);
-	m_ui->GameImage->setPixmap(buf);
+	if (!m_firstFrameShown)
+	{
+		m_firstFrameShown = true;
+		std::cout << "Startup: window shown after " << m_windowShownTime << " ms, first frame after "
+			<< m_startupTimer.elapsed() << " ms" << std::endl;
+	}
+	m_lastImage = image;
+	// Only the changed rows are upscaled and repainted
+	m_ui->GameImage->updateImage(image, dirtyTop, dirtyBottom);
+	m_emulatorThread->acknowledgeFrame();
 }
 
 void MainWindow::warning(QString errorString)
@@ -39,12 +100,30 @@ void MainWindow::warning(QString errorString)
 	messageBox.warning(this, "Warning", errorString);
 }
 
+void MainWindow::recordingStatus(QString status, bool recording)
+{
+	// Starting the recording can fail, the action has to reflect the actual state
+	QSignalBlocker blocker(m_ui->actionRecordGameplay);
+	m_ui->actionRecordGameplay->setChecked(recording);
+	m_ui->statusbar->showMessage(status);
+}
+
 void MainWindow::openROM()
 {
 	auto fileName = QFileDialog::getOpenFileName(this, "Open ROM", "ROMs", "ROM Files (*.gb *.gbc);; All (*.*)");
 	if (fileName.isEmpty())
 		return;
+	loadROM(fileName);
+}
+
+void MainWindow::loadROM(const QString& fileName)
+{
 	std::filesystem::path path(fileName.toStdU16String());
+	// The last shown frame of the previous game is used as its thumbnail in the library
+	m_romLibrary->setThumbnail(m_currentROM, m_lastImage);
+	m_romLibrary->setLastPlayed(path);
+	m_currentROM = path;
+	m_lastImage = {};
 	m_emulatorThread->setROM(std::move(path));
 }
 
@@ -56,6 +135,59 @@ void MainWindow::toggleInformationWindow()
 		m_informationWindow->hide();
 }
 
+void MainWindow::toggleRomLibraryWindow()
+{
+	if (m_romLibraryWindow->isHidden())
+		m_romLibraryWindow->show();
+	else
+		m_romLibraryWindow->hide();
+}
+
+void MainWindow::toggleTileDataWindow()
+{
+	if (m_tileDataWindow->isHidden())
+		m_tileDataWindow->show();
+	else
+		m_tileDataWindow->hide();
+}
+
+void MainWindow::updateFastBoot()
+{
+	const auto point = m_ui->actionFastBootAtFirstInput->isChecked() ? FastBootPoint::FirstInput : FastBootPoint::AfterFrames;
+	m_emulatorThread->setFastBoot(m_ui->actionFastBoot->isChecked(), point, m_fastBootFrame);
+}
+
+void MainWindow::fastForwardSpeedSelected(QAction* action)
+{
+	m_emulatorThread->setFastForwardSpeed(action->data().toDouble());
+}
+
+void MainWindow::showEvent(QShowEvent* event)
+{
+	QMainWindow::showEvent(event);
+	screenChanged(screen());
+	if (windowHandle())
+		connect(windowHandle(), &QWindow::screenChanged, this, &MainWindow::screenChanged, Qt::UniqueConnection);
+	if (m_windowShownTime >= 0)
+		return;
+
+	m_windowShownTime = m_startupTimer.elapsed();
+	std::cout << "Startup: window shown after " << m_windowShownTime << " ms" << std::endl;
+}
+
+void MainWindow::screenChanged(QScreen* screen)
+{
+	disconnect(m_refreshRateConnection);
+	if (!screen)
+		return;
+
+	m_emulatorThread->setDisplayRefreshRate(screen->refreshRate());
+	m_refreshRateConnection = connect(screen, &QScreen::refreshRateChanged, this, [this](qreal refreshRate)
+	{
+		m_emulatorThread->setDisplayRefreshRate(refreshRate);
+	});
+}
+
 void MainWindow::keyPressEvent(QKeyEvent* event)
 {
 	KeyEvent newEvent = { event->key(), true };
@@ -0,0 +1,551 @@
+#include "RomLibrary.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdio>
+#include <ctime>
+#include <unordered_map>
+#include <QDataStream>
+#include <QFile>
+#include <QMetaObject>
+#include <QSaveFile>
+
+static constexpr qint64 PAGE_SIZE = 0x1000;
+static constexpr qint64 HEADER_END = 0x150;
+static constexpr int TITLE_ADDRESS = 0x134;
+static constexpr int CGB_TITLE_LENGTH = 11;
+static constexpr int TITLE_LENGTH = 16;
+static constexpr int CGB_FLAG_ADDRESS = 0x143;
+static constexpr int CARTRIDGE_TYPE_ADDRESS = 0x147;
+static constexpr quint32 CACHE_MAGIC = 0x47474C42; // "GGLB"
+static constexpr quint32 CACHE_VERSION = 2;
+static const QSize THUMBNAIL_SIZE = QSize(80, 72);
+
+static constexpr auto CRC_TABLE = []()
+{
+	std::array<uint32_t, 256> table = {};
+	for (uint32_t i = 0; i < table.size(); i++)
+	{
+		uint32_t value = i;
+		for (int bit = 0; bit < 8; bit++)
+			value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+		table[i] = value;
+	}
+	return table;
+}();
+
+static QString toQString(const std::filesystem::path& path)
+{
+	return QString::fromStdU16String(path.u16string());
+}
+
+static std::string pathKey(const std::filesystem::path& path)
+{
+	return path.u8string();
+}
+
+std::filesystem::path normalizedRomPath(const std::filesystem::path& path)
+{
+	std::error_code ec;
+	auto absolute = std::filesystem::absolute(path, ec);
+	if (ec)
+		return path.lexically_normal();
+	return absolute.lexically_normal();
+}
+
+static std::filesystem::path thumbnailFilePath(const std::filesystem::path& thumbnailPath, uint32_t crc)
+{
+	return thumbnailPath / (QString("%1.png").arg(crc, 8, 16, QChar('0')).toUpper().toStdString());
+}
+
+static bool isRomFile(const std::filesystem::path& path)
+{
+	auto extension = path.extension().u8string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return extension == ".gb" || extension == ".gbc";
+}
+
+static uint32_t updateCRC(uint32_t crc, const uchar* data, qint64 size)
+{
+	for (qint64 i = 0; i < size; i++)
+		crc = CRC_TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return crc;
+}
+
+bool readRomHeader(const std::filesystem::path& path, RomInfo& info)
+{
+	QFile file(toQString(path));
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	if (file.size() < HEADER_END)
+		return false;
+
+	uchar* data = file.map(0, std::min(file.size(), PAGE_SIZE));
+	if (!data)
+		return false;
+
+	info.cgbFlag = data[CGB_FLAG_ADDRESS];
+	info.cartridgeType = data[CARTRIDGE_TYPE_ADDRESS];
+
+	// On CGB cartridges the end of the title area is used for the manufacturer code and the CGB flag
+	const int titleLength = (info.cgbFlag & 0x80) ? CGB_TITLE_LENGTH : TITLE_LENGTH;
+	info.title.clear();
+	for (int i = 0; i < titleLength; i++)
+	{
+		const auto character = static_cast<char>(data[TITLE_ADDRESS + i]);
+		if (character == '\0')
+			break;
+		if (character >= 0x20 && character < 0x7F)
+			info.title.push_back(character);
+	}
+	file.unmap(data);
+
+	return true;
+}
+
+uint32_t calculateFileCRC(const std::filesystem::path& path)
+{
+	QFile file(toQString(path));
+	if (!file.open(QIODevice::ReadOnly))
+		return 0;
+
+	uint32_t crc = 0xFFFFFFFFu;
+	const auto fileSize = file.size();
+	if (uchar* data = file.map(0, fileSize))
+	{
+		crc = updateCRC(crc, data, fileSize);
+		file.unmap(data);
+	}
+	else
+	{
+		const auto content = file.readAll();
+		crc = updateCRC(crc, reinterpret_cast<const uchar*>(content.constData()), content.size());
+	}
+
+	return crc ^ 0xFFFFFFFFu;
+}
+
+QString cartridgeTypeName(uint8_t cartridgeType)
+{
+	switch (cartridgeType)
+	{
+	case 0x00: return "ROM";
+	case 0x01: return "MBC1";
+	case 0x02: return "MBC1+RAM";
+	case 0x03: return "MBC1+RAM+BATTERY";
+	case 0x05: return "MBC2";
+	case 0x06: return "MBC2+BATTERY";
+	case 0x08: return "ROM+RAM";
+	case 0x09: return "ROM+RAM+BATTERY";
+	case 0x0F: return "MBC3+TIMER+BATTERY";
+	case 0x10: return "MBC3+TIMER+RAM+BATTERY";
+	case 0x11: return "MBC3";
+	case 0x12: return "MBC3+RAM";
+	case 0x13: return "MBC3+RAM+BATTERY";
+	case 0x19: return "MBC5";
+	case 0x1A: return "MBC5+RAM";
+	case 0x1B: return "MBC5+RAM+BATTERY";
+	case 0x1C: return "MBC5+RUMBLE";
+	case 0x1D: return "MBC5+RUMBLE+RAM";
+	case 0x1E: return "MBC5+RUMBLE+RAM+BATTERY";
+	default: return QString("Unknown (0x%1)").arg(cartridgeType, 2, 16, QChar('0'));
+	}
+}
+
+QString cgbFlagName(uint8_t cgbFlag)
+{
+	if (cgbFlag == 0xC0)
+		return "GBC only";
+	if (cgbFlag & 0x80)
+		return "GBC";
+	return "GB";
+}
+
+static std::vector<RomInfo> readCacheFile(const std::filesystem::path& cachePath, bool& valid)
+{
+	valid = false;
+	QFile file(toQString(cachePath));
+	if (!file.open(QIODevice::ReadOnly))
+		return {};
+
+	QDataStream stream(&file);
+	quint32 magic = 0;
+	quint32 version = 0;
+	quint32 count = 0;
+	stream >> magic >> version >> count;
+	if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+		return {};
+
+	std::vector<RomInfo> entries;
+	entries.reserve(count);
+	for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+	{
+		QString path;
+		QString title;
+		quint8 cgbFlag = 0;
+		quint8 cartridgeType = 0;
+		quint32 crc = 0;
+		quint64 fileSize = 0;
+		qint64 lastModified = 0;
+		qint64 lastPlayed = 0;
+		stream >> path >> title >> cgbFlag >> cartridgeType >> crc >> fileSize >> lastModified >> lastPlayed;
+
+		RomInfo info = {};
+		info.path = std::filesystem::path(path.toStdU16String());
+		info.title = title.toStdString();
+		info.cgbFlag = cgbFlag;
+		info.cartridgeType = cartridgeType;
+		info.crc = crc;
+		info.fileSize = fileSize;
+		info.lastModified = lastModified;
+		info.lastPlayed = lastPlayed;
+		entries.emplace_back(std::move(info));
+	}
+
+	if (stream.status() != QDataStream::Ok)
+	{
+		fprintf(stderr, "ROM library cache '%s' is corrupted, rebuilding it\n", cachePath.u8string().c_str());
+		return {};
+	}
+	valid = true;
+
+	return entries;
+}
+
+static void writeCacheFile(const std::filesystem::path& cachePath, const std::vector<RomInfo>& entries)
+{
+	std::error_code ec;
+	if (cachePath.has_parent_path())
+		std::filesystem::create_directories(cachePath.parent_path(), ec);
+
+	QSaveFile file(toQString(cachePath));
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		fprintf(stderr, "Unable to write ROM library cache '%s'\n", cachePath.u8string().c_str());
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream << CACHE_MAGIC << CACHE_VERSION << static_cast<quint32>(entries.size());
+	for (const auto& entry : entries)
+	{
+		stream << toQString(entry.path) << QString::fromStdString(entry.title) << static_cast<quint8>(entry.cgbFlag)
+			<< static_cast<quint8>(entry.cartridgeType) << static_cast<quint32>(entry.crc) << static_cast<quint64>(entry.fileSize)
+			<< static_cast<qint64>(entry.lastModified) << static_cast<qint64>(entry.lastPlayed);
+	}
+	file.commit();
+}
+
+RomLibraryScanner::RomLibraryScanner(std::filesystem::path gamesPath, std::filesystem::path thumbnailPath, std::vector<RomInfo> knownEntries,
+	std::set<uint32_t> loadedThumbnails, QObject* parent)
+	: QThread(parent)
+	, m_gamesPath(std::move(gamesPath))
+	, m_thumbnailPath(std::move(thumbnailPath))
+	, m_knownEntries(std::move(knownEntries))
+	, m_loadedThumbnails(std::move(loadedThumbnails))
+{
+}
+
+std::vector<RomInfo> RomLibraryScanner::takeResult()
+{
+	return std::move(m_result);
+}
+
+std::unordered_map<uint32_t, QImage> RomLibraryScanner::takeThumbnails()
+{
+	return std::move(m_thumbnails);
+}
+
+void RomLibraryScanner::run()
+{
+	std::unordered_map<std::string, size_t> knownIndices;
+	for (size_t i = 0; i < m_knownEntries.size(); i++)
+		knownIndices[pathKey(m_knownEntries[i].path)] = i;
+
+	std::error_code ec;
+	if (!std::filesystem::is_directory(m_gamesPath, ec))
+		return;
+
+	int scannedFiles = 0;
+	int hashedFiles = 0;
+	const auto options = std::filesystem::directory_options::skip_permission_denied;
+	for (auto it = std::filesystem::recursive_directory_iterator(m_gamesPath, options, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+	{
+		if (isInterruptionRequested())
+			return;
+
+		std::error_code entryError;
+		if (!it->is_regular_file(entryError) || !isRomFile(it->path()))
+			continue;
+
+		RomInfo info = {};
+		info.path = normalizedRomPath(it->path());
+		info.fileSize = it->file_size(entryError);
+		info.lastModified = it->last_write_time(entryError).time_since_epoch().count();
+		if (entryError)
+			continue;
+
+		scannedFiles++;
+		auto known = knownIndices.find(pathKey(info.path));
+		if (known != knownIndices.end())
+		{
+			const auto& knownEntry = m_knownEntries[known->second];
+			if (knownEntry.fileSize == info.fileSize && knownEntry.lastModified == info.lastModified)
+			{
+				m_result.emplace_back(knownEntry);
+				continue;
+			}
+			info.lastPlayed = knownEntry.lastPlayed;
+		}
+
+		if (!readRomHeader(info.path, info))
+			continue;
+		info.crc = calculateFileCRC(info.path);
+		m_result.emplace_back(std::move(info));
+
+		hashedFiles++;
+		if ((hashedFiles % 16) == 0)
+			emit progress(scannedFiles, hashedFiles);
+	}
+	emit progress(scannedFiles, hashedFiles);
+
+	// Thumbnails are decoded here as well, so opening a large library never decodes images on the GUI thread
+	for (const auto& entry : m_result)
+	{
+		if (isInterruptionRequested())
+			return;
+		if (m_loadedThumbnails.count(entry.crc) || m_thumbnails.count(entry.crc))
+			continue;
+
+		QImage thumbnail;
+		if (thumbnail.load(toQString(thumbnailFilePath(m_thumbnailPath, entry.crc))))
+			m_thumbnails[entry.crc] = std::move(thumbnail);
+	}
+}
+
+RomLibraryWriter::RomLibraryWriter(QObject* parent)
+	: QThread(parent)
+{
+}
+
+RomLibraryWriter::~RomLibraryWriter()
+{
+	{
+		std::scoped_lock lock(m_mutex);
+		m_stop = true;
+	}
+	m_condition.notify_one();
+	// The remaining jobs are small (at most one thumbnail and the metadata), they are finished before exiting
+	wait();
+}
+
+void RomLibraryWriter::post(std::function<void()> job)
+{
+	{
+		std::scoped_lock lock(m_mutex);
+		m_jobs.emplace_back(std::move(job));
+	}
+	m_condition.notify_one();
+}
+
+void RomLibraryWriter::run()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+			if (m_jobs.empty())
+				return;
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+		job();
+	}
+}
+
+RomLibrary::RomLibrary(std::filesystem::path gamesPath, std::filesystem::path cachePath, QObject* parent)
+	: QObject(parent)
+	, m_gamesPath(std::move(gamesPath))
+	, m_cachePath(std::move(cachePath))
+	, m_thumbnailPath(m_cachePath.parent_path() / "Thumbnails")
+{
+	m_writer = new RomLibraryWriter(this);
+	m_writer->start(QThread::LowPriority);
+}
+
+RomLibrary::~RomLibrary()
+{
+	delete m_writer;
+	if (!m_scanner)
+		return;
+
+	m_scanner->requestInterruption();
+	m_scanner->wait();
+}
+
+void RomLibrary::ensureLoaded()
+{
+	if (m_loaded)
+		return;
+
+	loadCache();
+	m_loaded = true;
+}
+
+void RomLibrary::refresh()
+{
+	ensureLoaded();
+	if (m_scanner)
+		return;
+
+	std::set<uint32_t> loadedThumbnails;
+	for (const auto& [crc, thumbnail] : m_thumbnails)
+		loadedThumbnails.insert(crc);
+
+	m_scanner = new RomLibraryScanner(m_gamesPath, m_thumbnailPath, m_entries, std::move(loadedThumbnails), this);
+	connect(m_scanner, &RomLibraryScanner::progress, this, &RomLibrary::refreshProgress);
+	connect(m_scanner, &QThread::finished, this, &RomLibrary::scanFinished);
+	m_scanner->start(QThread::LowPriority);
+}
+
+bool RomLibrary::isRefreshing() const
+{
+	return m_scanner != nullptr;
+}
+
+const std::vector<RomInfo>& RomLibrary::entries() const
+{
+	return m_entries;
+}
+
+QImage RomLibrary::thumbnail(uint32_t crc) const
+{
+	auto it = m_thumbnails.find(crc);
+	if (it == m_thumbnails.end())
+		return {};
+	return it->second;
+}
+
+std::filesystem::path RomLibrary::gamesPath() const
+{
+	return m_gamesPath;
+}
+
+void RomLibrary::setLastPlayed(const std::filesystem::path& path)
+{
+	const auto key = pathKey(normalizedRomPath(path));
+	const auto lastPlayed = static_cast<int64_t>(std::time(nullptr));
+	m_lastPlayed[key] = lastPlayed;
+
+	if (m_loaded)
+	{
+		if (auto entry = findEntry(path))
+		{
+			entry->lastPlayed = lastPlayed;
+			saveCache();
+			emit libraryChanged();
+		}
+		return;
+	}
+
+	// The library is not needed for playing, so the cache is only updated in the background
+	m_writer->post([cachePath = m_cachePath, key, lastPlayed]()
+	{
+		bool valid = false;
+		auto entries = readCacheFile(cachePath, valid);
+		auto it = std::find_if(entries.begin(), entries.end(), [&key](const RomInfo& entry) { return pathKey(entry.path) == key; });
+		if (it == entries.end())
+			return;
+		it->lastPlayed = lastPlayed;
+		writeCacheFile(cachePath, entries);
+	});
+}
+
+void RomLibrary::setThumbnail(const std::filesystem::path& path, const QImage& image)
+{
+	if (image.isNull() || path.empty())
+		return;
+
+	const auto entry = m_loaded ? findEntry(path) : nullptr;
+	const uint32_t knownCRC = entry ? entry->crc : 0;
+	m_writer->post([this, path, image, knownCRC, thumbnailPath = m_thumbnailPath]()
+	{
+		const auto crc = knownCRC ? knownCRC : calculateFileCRC(path);
+		auto thumbnail = image.scaled(THUMBNAIL_SIZE, Qt::KeepAspectRatio);
+		std::error_code ec;
+		std::filesystem::create_directories(thumbnailPath, ec);
+		if (!thumbnail.save(toQString(thumbnailFilePath(thumbnailPath, crc))))
+			fprintf(stderr, "Unable to write ROM library thumbnail for '%s'\n", path.u8string().c_str());
+
+		QMetaObject::invokeMethod(this, [this, crc, thumbnail]() { thumbnailSaved(crc, thumbnail); }, Qt::QueuedConnection);
+	});
+}
+
+void RomLibrary::scanFinished()
+{
+	auto result = m_scanner->takeResult();
+	for (auto& [crc, thumbnail] : m_scanner->takeThumbnails())
+		m_thumbnails[crc] = std::move(thumbnail);
+	m_scanner->deleteLater();
+	m_scanner = nullptr;
+
+	// Games may have been started on this thread while the scan was running
+	for (auto& entry : result)
+	{
+		auto lastPlayed = m_lastPlayed.find(pathKey(entry.path));
+		if (lastPlayed != m_lastPlayed.end())
+			entry.lastPlayed = lastPlayed->second;
+	}
+
+	m_entries = std::move(result);
+	saveCache();
+	emit libraryChanged();
+}
+
+void RomLibrary::thumbnailSaved(uint32_t crc, QImage thumbnail)
+{
+	m_thumbnails[crc] = std::move(thumbnail);
+	if (m_loaded)
+		emit libraryChanged();
+}
+
+RomInfo* RomLibrary::findEntry(const std::filesystem::path& path)
+{
+	const auto key = pathKey(normalizedRomPath(path));
+	auto it = std::find_if(m_entries.begin(), m_entries.end(), [&key](const RomInfo& entry)
+	{
+		return pathKey(entry.path) == key;
+	});
+
+	if (it == m_entries.end())
+		return nullptr;
+	return &(*it);
+}
+
+void RomLibrary::loadCache()
+{
+	bool valid = false;
+	auto entries = readCacheFile(m_cachePath, valid);
+	if (!valid)
+		return;
+
+	for (auto& entry : entries)
+	{
+		auto lastPlayed = m_lastPlayed.find(pathKey(entry.path));
+		if (lastPlayed != m_lastPlayed.end())
+			entry.lastPlayed = lastPlayed->second;
+	}
+	m_entries = std::move(entries);
+}
+
+void RomLibrary::saveCache()
+{
+	// Only metadata is written (thumbnails are separate files), the copy is cheap compared to the file access
+	m_writer->post([cachePath = m_cachePath, entries = m_entries]()
+	{
+		writeCacheFile(cachePath, entries);
+	});
+}
@@ -0,0 +1,95 @@
+#include "RomLibraryWindow.hpp"
+
+#include <QDateTime>
+#include <QPixmap>
+
+enum Column
+{
+	TITLE_COLUMN = 0,
+	FILE_COLUMN,
+	SYSTEM_COLUMN,
+	CARTRIDGE_COLUMN,
+	CRC_COLUMN,
+	LAST_PLAYED_COLUMN,
+	COLUMN_COUNT
+};
+
+RomLibraryWindow::RomLibraryWindow(RomLibrary* library, QWidget* parent)
+	: QWidget(parent)
+	, m_ui(new Ui::RomLibraryWindow)
+	, m_library(library)
+{
+	m_ui->setupUi(this);
+	setWindowFlags(Qt::Window);
+	m_ui->romTable->setColumnCount(COLUMN_COUNT);
+	m_ui->romTable->setHorizontalHeaderLabels({ "Title", "File", "System", "Cartridge", "CRC32", "Last played" });
+
+	connect(m_ui->refreshButton, &QPushButton::clicked, m_library, &RomLibrary::refresh);
+	connect(m_ui->romTable, &QTableWidget::cellDoubleClicked, this, &RomLibraryWindow::entryActivated);
+	connect(m_library, &RomLibrary::libraryChanged, this, &RomLibraryWindow::updateEntries);
+	connect(m_library, &RomLibrary::refreshProgress, this, &RomLibraryWindow::refreshProgress);
+}
+
+void RomLibraryWindow::showEvent(QShowEvent* event)
+{
+	QWidget::showEvent(event);
+	// Show the cached state immediately, the rescan only touches new or changed files
+	m_library->ensureLoaded();
+	updateEntries();
+	m_library->refresh();
+	m_ui->statusLabel->setText("Scanning...");
+}
+
+void RomLibraryWindow::updateEntries()
+{
+	if (isHidden())
+		return;
+
+	const auto& entries = m_library->entries();
+	auto table = m_ui->romTable;
+	table->setUpdatesEnabled(false);
+	table->setSortingEnabled(false);
+	table->clearContents();
+	table->setRowCount(static_cast<int>(entries.size()));
+
+	for (int row = 0; row < static_cast<int>(entries.size()); row++)
+	{
+		const auto& entry = entries[row];
+		const auto fileName = QString::fromStdU16String(entry.path.filename().u16string());
+		const auto title = entry.title.empty() ? fileName : QString::fromStdString(entry.title);
+		const auto lastPlayed = entry.lastPlayed ? QDateTime::fromSecsSinceEpoch(entry.lastPlayed).toString("yyyy-MM-dd hh:mm") : QString("-");
+
+		auto titleItem = new QTableWidgetItem(title);
+		titleItem->setData(Qt::UserRole, QString::fromStdU16String(entry.path.u16string()));
+		const auto thumbnail = m_library->thumbnail(entry.crc);
+		if (!thumbnail.isNull())
+			titleItem->setIcon(QPixmap::fromImage(thumbnail));
+
+		table->setItem(row, TITLE_COLUMN, titleItem);
+		table->setItem(row, FILE_COLUMN, new QTableWidgetItem(fileName));
+		table->setItem(row, SYSTEM_COLUMN, new QTableWidgetItem(cgbFlagName(entry.cgbFlag)));
+		table->setItem(row, CARTRIDGE_COLUMN, new QTableWidgetItem(cartridgeTypeName(entry.cartridgeType)));
+		table->setItem(row, CRC_COLUMN, new QTableWidgetItem(QString("%1").arg(entry.crc, 8, 16, QChar('0')).toUpper()));
+		table->setItem(row, LAST_PLAYED_COLUMN, new QTableWidgetItem(lastPlayed));
+	}
+
+	table->setSortingEnabled(true);
+	table->setUpdatesEnabled(true);
+
+	if (!m_library->isRefreshing())
+		m_ui->statusLabel->setText(QString("%1 ROMs").arg(entries.size()));
+}
+
+void RomLibraryWindow::refreshProgress(int scannedFiles, int hashedFiles)
+{
+	m_ui->statusLabel->setText(QString("Scanning... %1 files, %2 new or changed").arg(scannedFiles).arg(hashedFiles));
+}
+
+void RomLibraryWindow::entryActivated(int row, int column)
+{
+	auto item = m_ui->romTable->item(row, TITLE_COLUMN);
+	if (!item)
+		return;
+
+	emit romSelected(item->data(Qt::UserRole).toString());
+}
@@ -0,0 +1,185 @@
+#include "ThreadTuning.hpp"
+
+#include <cstring>
+#include <thread>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static constexpr int REALTIME_PRIORITY = 10;
+static constexpr int HIGH_PRIORITY_NICE_LEVEL = -10;
+
+static void updateMax(std::atomic<long long>& max, long long value)
+{
+	auto current = max.load(std::memory_order_relaxed);
+	while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+
+std::optional<ThreadPriority> threadPriorityFromString(const std::string& name)
+{
+	if (name == "normal")
+		return ThreadPriority::Normal;
+	if (name == "high")
+		return ThreadPriority::High;
+	if (name == "realtime")
+		return ThreadPriority::Realtime;
+	return std::nullopt;
+}
+
+#if defined(_WIN32)
+static bool pinThreadToCPU(int cpu, std::string& errors)
+{
+	// The affinity mask has one bit per core of the processor group
+	if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8))
+	{
+		errors += "; CPU " + std::to_string(cpu) + " is outside of the affinity mask";
+		return false;
+	}
+	if (SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) == 0)
+	{
+		errors += "; unable to pin thread to CPU " + std::to_string(cpu) + ", error: " + std::to_string(GetLastError());
+		return false;
+	}
+	return true;
+}
+
+static std::string setThreadPriority(ThreadPriority priority, std::string& errors)
+{
+	if (priority == ThreadPriority::Realtime)
+	{
+		if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+			return "time critical priority";
+		errors += "; unable to set time critical thread priority, error: " + std::to_string(GetLastError());
+	}
+	if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST))
+		return "highest priority";
+	errors += "; unable to set highest thread priority, error: " + std::to_string(GetLastError());
+
+	return "normal priority";
+}
+#elif defined(__linux__)
+static bool pinThreadToCPU(int cpu, std::string& errors)
+{
+	if (cpu >= CPU_SETSIZE)
+	{
+		errors += "; CPU " + std::to_string(cpu) + " is outside of the CPU set";
+		return false;
+	}
+
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(cpu, &cpuSet);
+	const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+	if (error != 0)
+	{
+		errors += "; unable to pin thread to CPU " + std::to_string(cpu) + ": " + strerror(error);
+		return false;
+	}
+	return true;
+}
+
+static std::string setThreadPriority(ThreadPriority priority, std::string& errors)
+{
+	if (priority == ThreadPriority::Realtime)
+	{
+		sched_param parameter = {};
+		parameter.sched_priority = REALTIME_PRIORITY;
+		const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameter);
+		if (error == 0)
+			return "SCHED_FIFO priority " + std::to_string(REALTIME_PRIORITY);
+		// Usually EPERM, needs CAP_SYS_NICE or an rtprio limit
+		errors += std::string("; unable to use SCHED_FIFO: ") + strerror(error);
+	}
+
+	// On Linux the nice level of a single thread can be changed through its thread id
+	const auto threadID = static_cast<id_t>(syscall(SYS_gettid));
+	if (setpriority(PRIO_PROCESS, threadID, HIGH_PRIORITY_NICE_LEVEL) == 0)
+		return "nice level " + std::to_string(HIGH_PRIORITY_NICE_LEVEL);
+	errors += "; unable to set nice level " + std::to_string(HIGH_PRIORITY_NICE_LEVEL) + ": " + strerror(errno);
+
+	return "normal priority";
+}
+#else
+static bool pinThreadToCPU(int cpu, std::string& errors)
+{
+	errors += "; pinning threads to a CPU is not supported on this platform";
+	return false;
+}
+
+static std::string setThreadPriority(ThreadPriority priority, std::string& errors)
+{
+	errors += "; changing the thread priority is not supported on this platform";
+	return "normal priority";
+}
+#endif
+
+static bool isValidCPU(int cpu, std::string& errors)
+{
+	// hardware_concurrency() returns 0 if the number of cores is unknown, the platform checks still apply then
+	const auto cpuCount = std::thread::hardware_concurrency();
+	if ((cpuCount != 0) && (static_cast<unsigned int>(cpu) >= cpuCount))
+	{
+		errors += "; CPU " + std::to_string(cpu) + " does not exist, there are " + std::to_string(cpuCount) + " cores";
+		return false;
+	}
+	return true;
+}
+
+std::string applyThreadSettings(const ThreadSettings& settings, const std::string& threadName)
+{
+	std::string errors;
+	std::string description = threadName + ": ";
+	if ((settings.cpu >= 0) && isValidCPU(settings.cpu, errors) && pinThreadToCPU(settings.cpu, errors))
+		description += "pinned to CPU " + std::to_string(settings.cpu);
+	else
+		description += "no CPU affinity";
+
+	if (settings.priority == ThreadPriority::Normal)
+		description += ", normal priority";
+	else
+		description += ", " + setThreadPriority(settings.priority, errors);
+
+	return description + errors;
+}
+
+void JitterProbe::addSample(long long expectedIntervalInNanoSeconds, long long actualIntervalInNanoSeconds)
+{
+	const auto lateness = actualIntervalInNanoSeconds - expectedIntervalInNanoSeconds;
+	const bool deadlineMissed = lateness > static_cast<long long>(expectedIntervalInNanoSeconds * DEADLINE_TOLERANCE);
+
+	m_samples++;
+	m_totalSamples++;
+	if (deadlineMissed)
+	{
+		m_deadlineMisses++;
+		m_totalDeadlineMisses++;
+	}
+	updateMax(m_maxLateness, lateness);
+	updateMax(m_totalMaxLateness, lateness);
+}
+
+JitterProbe::Statistics JitterProbe::takeStatistics()
+{
+	Statistics statistics = {};
+	statistics.samples = m_samples.exchange(0);
+	statistics.deadlineMisses = m_deadlineMisses.exchange(0);
+	statistics.maxLatenessInNanoSeconds = m_maxLateness.exchange(0);
+	return statistics;
+}
+
+JitterProbe::Statistics JitterProbe::totalStatistics() const
+{
+	Statistics statistics = {};
+	statistics.samples = m_totalSamples;
+	statistics.deadlineMisses = m_totalDeadlineMisses;
+	statistics.maxLatenessInNanoSeconds = m_totalMaxLateness;
+	return statistics;
+}
@@ -0,0 +1,134 @@
+#include "TileDataViewer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr int TILE_SIZE = 8;
+// The tile data rarely changes every frame, copying every second frame is plenty for a debug view
+static constexpr int SNAPSHOT_EVERY_FRAMES = 2;
+static constexpr unsigned long VIEWER_POLL_INTERVAL_MS = 8;
+
+TileDataSnapshots::Snapshot& TileDataSnapshots::backBuffer()
+{
+	return m_buffers[m_backIndex];
+}
+
+void TileDataSnapshots::publish()
+{
+	m_backIndex = m_latest.exchange(m_backIndex | NEW_SNAPSHOT_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+const TileDataSnapshots::Snapshot* TileDataSnapshots::takeLatest()
+{
+	if (!(m_latest.load(std::memory_order_acquire) & NEW_SNAPSHOT_BIT))
+		return nullptr;
+
+	m_frontIndex = m_latest.exchange(m_frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+	return &m_buffers[m_frontIndex];
+}
+
+TileDataRenderer::TileDataRenderer(TileDataSnapshots* snapshots)
+	: m_snapshots(snapshots)
+{
+}
+
+void TileDataRenderer::renderNewFrame(const ggb::FrameBuffer& framebuffer)
+{
+	if (!m_snapshots->enabled.load(std::memory_order_relaxed))
+		return;
+
+	m_frameCounter++;
+	if (m_frameCounter < SNAPSHOT_EVERY_FRAMES)
+		return;
+	m_frameCounter = 0;
+
+	// The emulator thread only copies the framebuffer in bulk, the per pixel conversion runs on the viewer thread
+	m_snapshots->backBuffer().framebuffer = framebuffer;
+	m_snapshots->publish();
+}
+
+TileDataViewerThread::TileDataViewerThread(TileDataSnapshots* snapshots, QObject* parent)
+	: QThread(parent)
+	, m_snapshots(snapshots)
+{
+}
+
+void TileDataViewerThread::run()
+{
+	while (!isInterruptionRequested())
+	{
+		auto snapshot = m_snapshots->takeLatest();
+		if (!snapshot)
+		{
+			msleep(VIEWER_POLL_INTERVAL_MS);
+			continue;
+		}
+
+		if (!snapshot->framebuffer)
+			continue;
+
+		const int changedTiles = updateImage(*snapshot);
+		if (changedTiles == 0)
+			continue;
+
+		const int totalTiles = (m_image.width() / TILE_SIZE) * (m_image.height() / TILE_SIZE);
+		emit tileDataUpdated(m_image, changedTiles, totalTiles);
+	}
+}
+
+int TileDataViewerThread::updateImage(const TileDataSnapshots::Snapshot& snapshot)
+{
+	const auto& framebuffer = *snapshot.framebuffer;
+	const int width = static_cast<int>(framebuffer.width());
+	const int height = static_cast<int>(framebuffer.height());
+	m_pixels.resize(framebuffer.width() * framebuffer.height());
+	auto pixel = m_pixels.begin();
+	for (size_t y = 0; y < framebuffer.height(); y++)
+	{
+		for (size_t x = 0; x < framebuffer.width(); x++)
+		{
+			const auto& color = framebuffer.getPixel(x, y);
+			*pixel++ = (static_cast<uint32_t>(color.r) << 16) | (static_cast<uint32_t>(color.g) << 8) | color.b;
+		}
+	}
+
+	const bool fullUpdate = (m_image.width() != width) || (m_image.height() != height) || (m_previousPixels.size() != m_pixels.size());
+	if (fullUpdate)
+	{
+		m_image = QImage(QSize(width, height), QImage::Format_RGB32);
+		m_previousPixels.assign(m_pixels.size(), 0);
+	}
+
+	int changedTiles = 0;
+	const size_t tileRowSize = TILE_SIZE * sizeof(uint32_t);
+	for (int tileY = 0; tileY < height; tileY += TILE_SIZE)
+	{
+		const int tileHeight = std::min(TILE_SIZE, height - tileY);
+		for (int tileX = 0; tileX < width; tileX += TILE_SIZE)
+		{
+			const int tileWidth = std::min(TILE_SIZE, width - tileX);
+			const size_t rowSize = (tileWidth == TILE_SIZE) ? tileRowSize : tileWidth * sizeof(uint32_t);
+
+			bool tileChanged = fullUpdate;
+			for (int y = tileY; (y < tileY + tileHeight) && !tileChanged; y++)
+			{
+				const size_t offset = static_cast<size_t>(y) * width + tileX;
+				tileChanged = std::memcmp(&m_pixels[offset], &m_previousPixels[offset], rowSize) != 0;
+			}
+			if (!tileChanged)
+				continue;
+
+			changedTiles++;
+			for (int y = tileY; y < tileY + tileHeight; y++)
+			{
+				const size_t offset = static_cast<size_t>(y) * width + tileX;
+				std::memcpy(&m_previousPixels[offset], &m_pixels[offset], rowSize);
+				QRgb* scanLine = reinterpret_cast<QRgb*>(m_image.scanLine(y)) + tileX;
+				for (int x = 0; x < tileWidth; x++)
+					scanLine[x] = 0xFF000000u | m_pixels[offset + x];
+			}
+		}
+	}
+
+	return changedTiles;
+}
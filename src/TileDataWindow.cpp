@@ -0,0 +1,47 @@
+#include "TileDataWindow.hpp"
+
+#include <QPixmap>
+
+static constexpr int TILE_DATA_IMAGE_SCALE = 2;
+
+TileDataWindow::TileDataWindow(TileDataSnapshots* snapshots, QWidget* parent)
+	: QWidget(parent)
+	, m_ui(new Ui::TileDataWindow)
+	, m_snapshots(snapshots)
+{
+	m_ui->setupUi(this);
+	setWindowFlags(Qt::Window);
+	m_viewerThread = new TileDataViewerThread(m_snapshots, this);
+	connect(m_viewerThread, &TileDataViewerThread::tileDataUpdated, this, &TileDataWindow::tileDataUpdated);
+}
+
+TileDataWindow::~TileDataWindow()
+{
+	stopViewerThread();
+}
+
+void TileDataWindow::showEvent(QShowEvent* event)
+{
+	QWidget::showEvent(event);
+	m_snapshots->enabled = true;
+	m_viewerThread->start(QThread::LowPriority);
+}
+
+void TileDataWindow::hideEvent(QHideEvent* event)
+{
+	QWidget::hideEvent(event);
+	stopViewerThread();
+}
+
+void TileDataWindow::tileDataUpdated(QImage image, int changedTiles, int totalTiles)
+{
+	m_ui->tileDataImage->setPixmap(QPixmap::fromImage(image.scaled(image.size() * TILE_DATA_IMAGE_SCALE)));
+	m_ui->statusLabel->setText(QString("Updated %1 of %2 tiles").arg(changedTiles).arg(totalTiles));
+}
+
+void TileDataWindow::stopViewerThread()
+{
+	m_snapshots->enabled = false;
+	m_viewerThread->requestInterruption();
+	m_viewerThread->wait();
+}
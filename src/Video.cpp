@@ -1,29 +1,84 @@
 #include "Video.hpp"
 
-QTRenderer::QTRenderer(int width, int height)
-	: m_width(width), m_height(height)
+#include <algorithm>
+#include <cstring>
+
+static constexpr long long NANO_SECONDS_PER_SECOND = 1000000000;
+static constexpr int MAX_FRAMES_IN_FLIGHT = 1;
+// If the GUI never acknowledges a frame (e.g. it was dropped), present anyway after this time
+static constexpr long long BACKPRESSURE_TIMEOUT = NANO_SECONDS_PER_SECOND / 10;
+// Tolerance so frames arriving at the display rate (1x speed) are never skipped because of timer jitter
+static constexpr double DISPLAY_INTERVAL_TOLERANCE = 0.9;
+
+QTRenderer::QTRenderer(int width, int height, PresentationFeedback* feedback, GameplayRecorder* recorder)
+	: m_feedback(feedback), m_recorder(recorder), m_width(width), m_height(height)
 {
 }
 
 void QTRenderer::renderNewFrame(const ggb::FrameBuffer& framebuffer)
 {
-	m_skipImageCounter++;
-	if (m_skipImageCounter < m_frameSkipCount)
+	m_frameCount++;
+	if (m_feedback)
+		m_feedback->emulatedFrames++;
+	// Every emulated frame is recorded, independent of what the GUI displays
+	if (m_recorder)
+		m_recorder->pushVideoFrame(framebuffer);
+	if (!shouldConvertFrame())
+	{
+		if (m_feedback)
+			m_feedback->skippedFrames++;
 		return;
+	}
 
-	m_skipImageCounter = 0;
-	m_hasNewImage = true;
-	m_image = QImage(QSize(m_width, m_height), QImage::Format_RGB32);
+	if (m_image.isNull())
+	{
+		m_image = QImage(QSize(m_width, m_height), QImage::Format_RGB32);
+		m_fullUpdate = true;
+	}
+
+	const auto width = std::min(framebuffer.width(), static_cast<size_t>(m_width));
+	const auto height = std::min(framebuffer.height(), static_cast<size_t>(m_height));
+	const auto lineSize = width * sizeof(QRgb);
+	m_lineBuffer.resize(width);
 
-	for (size_t y = 0; y < framebuffer.height(); y++)
+	bool frameChanged = false;
+	for (size_t y = 0; y < height; y++)
 	{
-		QRgb* scanLine = reinterpret_cast<QRgb*>(m_image.scanLine(static_cast<int>(y)));
-		for (size_t x = 0; x < framebuffer.width(); x++)
+		for (size_t x = 0; x < width; x++)
 		{
 			const auto& ggbColor = framebuffer.getPixel(x, y);
-			scanLine[x] = qRgb(ggbColor.r, ggbColor.g, ggbColor.b);
+			m_lineBuffer[x] = qRgb(ggbColor.r, ggbColor.g, ggbColor.b);
 		}
+
+		// Only lines which changed are written, this keeps the image shared with the GUI for unchanged frames
+		const int row = static_cast<int>(y);
+		if (!m_fullUpdate && (std::memcmp(m_image.constScanLine(row), m_lineBuffer.data(), lineSize) == 0))
+			continue;
+
+		std::memcpy(m_image.scanLine(row), m_lineBuffer.data(), lineSize);
+		if (m_dirtyRows.top > m_dirtyRows.bottom)
+		{
+			m_dirtyRows = { row, row };
+		}
+		else
+		{
+			m_dirtyRows.top = std::min(m_dirtyRows.top, row);
+			m_dirtyRows.bottom = std::max(m_dirtyRows.bottom, row);
+		}
+		frameChanged = true;
+	}
+	m_fullUpdate = false;
+
+	if (!frameChanged)
+	{
+		if (m_feedback)
+			m_feedback->unchangedFrames++;
+		return;
 	}
+
+	m_hasNewImage = true;
+	if (m_feedback)
+		m_feedback->presentedFrames++;
 }
 
 bool QTRenderer::hasNewImage() const
@@ -31,13 +86,74 @@ bool QTRenderer::hasNewImage() const
 	return m_hasNewImage;
 }
 
+DirtyRows QTRenderer::dirtyRows() const
+{
+	return m_dirtyRows;
+}
+
 QImage QTRenderer::getCurrentImage()
 {
 	m_hasNewImage = false;
+	m_dirtyRows = {};
 	return m_image;
 }
 
+void QTRenderer::forceFullUpdate()
+{
+	m_fullUpdate = true;
+}
+
 void QTRenderer::setFrameSkip(int skipFrames)
 {
 	m_frameSkipCount = skipFrames;
 }
+
+uint64_t QTRenderer::frameCount() const
+{
+	return m_frameCount;
+}
+
+bool QTRenderer::shouldConvertFrame()
+{
+	const auto currentTime = ggb::getCurrentTimeInNanoSeconds();
+	if (m_lastFrameTime != 0)
+		m_averageFrameInterval += (static_cast<double>(currentTime - m_lastFrameTime) - m_averageFrameInterval) / 8.0;
+	m_lastFrameTime = currentTime;
+
+	if (m_frameSkipCount > 0)
+	{
+		m_skipImageCounter++;
+		if (m_skipImageCounter < m_frameSkipCount)
+			return false;
+		m_skipImageCounter = 0;
+		return true;
+	}
+
+	if (!m_feedback)
+		return true;
+
+	const auto timeSincePresentation = currentTime - m_lastPresentationTime;
+	const bool guiBusy = m_feedback->framesInFlight >= MAX_FRAMES_IN_FLIGHT;
+	if (guiBusy && (timeSincePresentation < BACKPRESSURE_TIMEOUT))
+		return false;
+
+	const auto displayInterval = static_cast<long long>(NANO_SECONDS_PER_SECOND / m_feedback->displayRefreshRate);
+	if (m_averageFrameInterval >= displayInterval * DISPLAY_INTERVAL_TOLERANCE)
+	{
+		// The display keeps up with the emulator, every frame is presented
+		m_lastPresentationTime = currentTime;
+		m_nextPresentationTime = currentTime + displayInterval;
+		return true;
+	}
+
+	// Faster frames (e.g. fast forward or 1x on a 50 Hz display) are thinned to one per display interval.
+	// The deadline advances by whole intervals, resetting it to the current time would alias to every other frame
+	if (currentTime < m_nextPresentationTime)
+		return false;
+
+	m_nextPresentationTime += displayInterval;
+	if (m_nextPresentationTime <= currentTime)
+		m_nextPresentationTime = currentTime + displayInterval;
+	m_lastPresentationTime = currentTime;
+	return true;
+}
@@ -1,4 +1,7 @@
 //#include "EmulatorMain.hpp"
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
 #include "MainWindow.hpp"
 
 // Needed because of SDL
@@ -6,12 +9,64 @@
 
 int main(int argc, char* argv[])
 {
+	QElapsedTimer startupTimer;
+	startupTimer.start();
+
 	QApplication app(argc, argv);
-	MainWindow window;
+	QCommandLineParser parser;
+	parser.addHelpOption();
+	parser.addPositionalArgument("rom", "ROM file which is started right away");
+	QCommandLineOption emulatorCPUOption("emulator-cpu", "Pins the emulator thread to the given CPU core.", "cpu");
+	QCommandLineOption audioCPUOption("audio-cpu", "Pins the audio thread to the given CPU core.", "cpu");
+	QCommandLineOption emulatorPriorityOption("emulator-priority", "Priority of the emulator thread: normal or high (realtime is capped to high).", "priority", "normal");
+	QCommandLineOption audioPriorityOption("audio-priority", "Priority of the audio thread: normal, high or realtime.", "priority", "normal");
+	QCommandLineOption fastBootFrameOption("fast-boot-frame", "Frames after a cold start at which the fast boot snapshot is taken.", "frames",
+		QString::number(EmulatorThread::DEFAULT_FAST_BOOT_FRAME));
+	parser.addOptions({ emulatorCPUOption, audioCPUOption, emulatorPriorityOption, audioPriorityOption, fastBootFrameOption });
+	parser.process(app);
+
+	auto threadSettings = [&parser](const QCommandLineOption& cpuOption, const QCommandLineOption& priorityOption)
+	{
+		ThreadSettings settings = {};
+		if (parser.isSet(cpuOption))
+		{
+			bool valid = false;
+			settings.cpu = parser.value(cpuOption).toInt(&valid);
+			if (!valid || settings.cpu < 0)
+			{
+				fprintf(stderr, "Invalid CPU core: %s\n", qPrintable(parser.value(cpuOption)));
+				settings.cpu = -1;
+			}
+		}
+
+		const auto priority = threadPriorityFromString(parser.value(priorityOption).toStdString());
+		if (priority)
+			settings.priority = *priority;
+		else
+			fprintf(stderr, "Invalid thread priority: %s\n", qPrintable(parser.value(priorityOption)));
+
+		return settings;
+	};
+
+	bool validFastBootFrame = false;
+	int fastBootFrame = parser.value(fastBootFrameOption).toInt(&validFastBootFrame);
+	if (!validFastBootFrame || fastBootFrame < 0)
+	{
+		fprintf(stderr, "Invalid fast boot frame: %s\n", qPrintable(parser.value(fastBootFrameOption)));
+		fastBootFrame = EmulatorThread::DEFAULT_FAST_BOOT_FRAME;
+	}
+
+	MainWindow window(startupTimer, threadSettings(emulatorCPUOption, emulatorPriorityOption), threadSettings(audioCPUOption, audioPriorityOption),
+		fastBootFrame);
 	window.show();
+
+	const auto arguments = parser.positionalArguments();
+	if (!arguments.isEmpty())
+		window.loadROM(arguments.first());
+
 	return app.exec();
 	//EmulatorApplication application;
 
 	//return application.run();
 	return 0;
-}
\ No newline at end of file
+}
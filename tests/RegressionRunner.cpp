@@ -0,0 +1,471 @@
+// Headless regression and performance runner, used by CTest (see GGBOY_BUILD_TESTS)
+//
+// Usage: GGBoyRegression <directory> [--check hashes|determinism|performance] [--tolerance <percent>] [--require-baseline] [--update]
+// The directory contains workloads.txt, goldens.txt and baseline.txt, --update (re)writes the latter two from the current run.
+// The determinism check runs every workload a second time and compares the hashes, it needs neither goldens nor baseline.
+// Goldens belong to the repository, without them the hash check fails. The baseline is machine specific, without it the
+// performance check is reported as skipped unless --require-baseline is given.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <Emulator.hpp>
+#include <RenderingUtility.hpp>
+
+static constexpr int SKIP_RETURN_CODE = 77;
+static constexpr double UNCAPPED_SPEED = 1000.0;
+// A frame takes 70224 clock cycles, a core which steps this often without finishing one has stopped producing frames (e.g. LCD off)
+static constexpr uint64_t MAX_STEPS_PER_FRAME = 10000000;
+static constexpr double MAX_WORKLOAD_SECONDS = 120.0;
+// The throughput is the best of several runs, a single short run is too noisy for the tolerance
+static constexpr int PERFORMANCE_RUNS = 5;
+static const std::string WORKLOADS_FILE = "workloads.txt";
+static const std::string GOLDENS_FILE = "goldens.txt";
+static const std::string BASELINE_FILE = "baseline.txt";
+
+struct InputChange
+{
+	uint64_t frame = 0;
+	ggb::GameboyInput input = {};
+};
+
+struct Workload
+{
+	std::string name;
+	std::filesystem::path rom;
+	std::filesystem::path savestate;
+	std::filesystem::path inputMovie;
+	uint64_t frames = 0;
+	std::set<uint64_t> checkpoints;
+};
+
+struct WorkloadResult
+{
+	std::map<uint64_t, uint64_t> hashes;
+	double framesPerSecond = 0.0;
+};
+
+class HashingRenderer : public ggb::Renderer
+{
+public:
+	HashingRenderer(const std::set<uint64_t>* checkpoints, std::map<uint64_t, uint64_t>* hashes)
+		: m_checkpoints(checkpoints), m_hashes(hashes)
+	{
+	}
+
+	void renderNewFrame(const ggb::FrameBuffer& framebuffer) override
+	{
+		m_frameCount++;
+		if (!m_checkpoints->count(m_frameCount))
+			return;
+
+		// FNV-1a over the RGB values of all pixels
+		uint64_t hash = 14695981039346656037ull;
+		auto addByte = [&hash](uint8_t value)
+		{
+			hash ^= value;
+			hash *= 1099511628211ull;
+		};
+		for (size_t y = 0; y < framebuffer.height(); y++)
+		{
+			for (size_t x = 0; x < framebuffer.width(); x++)
+			{
+				const auto& color = framebuffer.getPixel(x, y);
+				addByte(color.r);
+				addByte(color.g);
+				addByte(color.b);
+			}
+		}
+		(*m_hashes)[m_frameCount] = hash;
+	}
+
+	uint64_t frameCount() const
+	{
+		return m_frameCount;
+	}
+
+private:
+	const std::set<uint64_t>* m_checkpoints = nullptr;
+	std::map<uint64_t, uint64_t>* m_hashes = nullptr;
+	uint64_t m_frameCount = 0;
+};
+
+static std::vector<std::string> splitLine(const std::string& line)
+{
+	std::vector<std::string> tokens;
+	std::stringstream stream(line);
+	std::string token;
+	while (stream >> token)
+	{
+		if (token.front() == '#')
+			break;
+		tokens.emplace_back(token);
+	}
+
+	return tokens;
+}
+
+static std::vector<std::vector<std::string>> readLines(const std::filesystem::path& path)
+{
+	std::vector<std::vector<std::string>> lines;
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line))
+	{
+		auto tokens = splitLine(line);
+		if (!tokens.empty())
+			lines.emplace_back(std::move(tokens));
+	}
+
+	return lines;
+}
+
+// Line format: <name> <rom> <frames> <checkpoint,checkpoint,...> [savestate=<file>] [input=<file>]
+static bool readWorkloads(const std::filesystem::path& directory, std::vector<Workload>& workloads)
+{
+	for (const auto& tokens : readLines(directory / WORKLOADS_FILE))
+	{
+		if (tokens.size() < 4)
+		{
+			fprintf(stderr, "Invalid workload, expected <name> <rom> <frames> <checkpoints>: %s\n", tokens.front().c_str());
+			return false;
+		}
+
+		Workload workload = {};
+		workload.name = tokens[0];
+		workload.rom = directory / tokens[1];
+		workload.frames = std::strtoull(tokens[2].c_str(), nullptr, 10);
+		std::stringstream checkpoints(tokens[3]);
+		std::string checkpoint;
+		while (std::getline(checkpoints, checkpoint, ','))
+			workload.checkpoints.insert(std::strtoull(checkpoint.c_str(), nullptr, 10));
+
+		for (size_t i = 4; i < tokens.size(); i++)
+		{
+			const auto& option = tokens[i];
+			if (option.rfind("savestate=", 0) == 0)
+				workload.savestate = directory / option.substr(std::string("savestate=").size());
+			else if (option.rfind("input=", 0) == 0)
+				workload.inputMovie = directory / option.substr(std::string("input=").size());
+			else
+				fprintf(stderr, "Ignoring unknown workload option: %s\n", option.c_str());
+		}
+		workloads.emplace_back(std::move(workload));
+	}
+
+	return true;
+}
+
+// Line format: <frame> <buttons>, buttons are separated by commas (A,B,START,SELECT,UP,DOWN,LEFT,RIGHT) or "-" for none.
+// An input stays pressed until the next line
+static std::vector<InputChange> readInputMovie(const std::filesystem::path& path)
+{
+	std::vector<InputChange> inputMovie;
+	for (const auto& tokens : readLines(path))
+	{
+		InputChange change = {};
+		change.frame = std::strtoull(tokens[0].c_str(), nullptr, 10);
+		std::stringstream buttons(tokens.size() > 1 ? tokens[1] : "-");
+		std::string button;
+		while (std::getline(buttons, button, ','))
+		{
+			change.input.isAPressed |= (button == "A");
+			change.input.isBPressed |= (button == "B");
+			change.input.isStartPressed |= (button == "START");
+			change.input.isSelectPressed |= (button == "SELECT");
+			change.input.isUpPressed |= (button == "UP");
+			change.input.isDownPressed |= (button == "DOWN");
+			change.input.isLeftPressed |= (button == "LEFT");
+			change.input.isRightPressed |= (button == "RIGHT");
+		}
+		inputMovie.emplace_back(change);
+	}
+
+	return inputMovie;
+}
+
+static bool runWorkload(const Workload& workload, WorkloadResult& result)
+{
+	auto emulator = std::make_unique<ggb::Emulator>();
+	auto renderer = std::make_unique<HashingRenderer>(&workload.checkpoints, &result.hashes);
+	const auto hashingRenderer = renderer.get();
+	emulator->setGameRenderer(std::move(renderer));
+
+	try
+	{
+		emulator->loadCartridge(workload.rom);
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "%s: unable to load ROM %s: %s\n", workload.name.c_str(), workload.rom.string().c_str(), e.what());
+		return false;
+	}
+	if (!workload.savestate.empty() && !emulator->loadEmulatorState(workload.savestate))
+	{
+		fprintf(stderr, "%s: unable to load savestate %s\n", workload.name.c_str(), workload.savestate.string().c_str());
+		return false;
+	}
+
+	const auto inputMovie = workload.inputMovie.empty() ? std::vector<InputChange>() : readInputMovie(workload.inputMovie);
+	size_t nextInput = 0;
+	uint64_t lastFrame = 0;
+	emulator->setEmulationSpeed(UNCAPPED_SPEED);
+
+	const auto startTime = std::chrono::steady_clock::now();
+	uint64_t stepsSinceFrame = 0;
+	while (hashingRenderer->frameCount() < workload.frames)
+	{
+		emulator->step();
+
+		// Inputs are applied between frames, so they are independent of how long a step takes
+		const auto frame = hashingRenderer->frameCount();
+		if (frame == lastFrame)
+		{
+			if (++stepsSinceFrame < MAX_STEPS_PER_FRAME)
+				continue;
+
+			fprintf(stderr, "%s: no new frame after frame %llu within %llu steps\n", workload.name.c_str(),
+				static_cast<unsigned long long>(frame), static_cast<unsigned long long>(MAX_STEPS_PER_FRAME));
+			return false;
+		}
+		lastFrame = frame;
+		stepsSinceFrame = 0;
+		const std::chrono::duration<double> runTime = std::chrono::steady_clock::now() - startTime;
+		if (runTime.count() > MAX_WORKLOAD_SECONDS)
+		{
+			fprintf(stderr, "%s: exceeded %.0f seconds at frame %llu of %llu\n", workload.name.c_str(), MAX_WORKLOAD_SECONDS,
+				static_cast<unsigned long long>(frame), static_cast<unsigned long long>(workload.frames));
+			return false;
+		}
+		while ((nextInput < inputMovie.size()) && (inputMovie[nextInput].frame <= frame))
+			emulator->setInputState(inputMovie[nextInput++].input);
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+	result.framesPerSecond = workload.frames / elapsed.count();
+
+	return true;
+}
+
+static bool checkHashes(const std::vector<Workload>& workloads, const std::map<std::string, WorkloadResult>& results, const std::filesystem::path& directory)
+{
+	std::map<std::pair<std::string, uint64_t>, uint64_t> goldens;
+	for (const auto& tokens : readLines(directory / GOLDENS_FILE))
+	{
+		if (tokens.size() >= 3)
+			goldens[{ tokens[0], std::strtoull(tokens[1].c_str(), nullptr, 10) }] = std::strtoull(tokens[2].c_str(), nullptr, 16);
+	}
+
+	bool success = true;
+	for (const auto& workload : workloads)
+	{
+		const auto& hashes = results.at(workload.name).hashes;
+		for (auto checkpoint : workload.checkpoints)
+		{
+			auto golden = goldens.find({ workload.name, checkpoint });
+			auto hash = hashes.find(checkpoint);
+			if (golden == goldens.end())
+			{
+				std::cout << "FAIL " << workload.name << " frame " << checkpoint << ": no golden hash, run with --update" << std::endl;
+				success = false;
+			}
+			else if (hash == hashes.end())
+			{
+				std::cout << "FAIL " << workload.name << " frame " << checkpoint << ": frame was not reached" << std::endl;
+				success = false;
+			}
+			else if (golden->second != hash->second)
+			{
+				std::cout << "FAIL " << workload.name << " frame " << checkpoint << ": hash " << std::hex << hash->second
+					<< " expected " << golden->second << std::dec << std::endl;
+				success = false;
+			}
+			else
+			{
+				std::cout << "OK   " << workload.name << " frame " << checkpoint << std::endl;
+			}
+		}
+	}
+
+	return success;
+}
+
+static bool checkDeterminism(const std::vector<Workload>& workloads, const std::map<std::string, WorkloadResult>& results)
+{
+	bool success = true;
+	for (const auto& workload : workloads)
+	{
+		WorkloadResult repeated = {};
+		if (!runWorkload(workload, repeated))
+		{
+			success = false;
+			continue;
+		}
+
+		const auto& hashes = results.at(workload.name).hashes;
+		for (auto checkpoint : workload.checkpoints)
+		{
+			auto hash = hashes.find(checkpoint);
+			auto repeatedHash = repeated.hashes.find(checkpoint);
+			if ((hash == hashes.end()) || (repeatedHash == repeated.hashes.end()))
+			{
+				std::cout << "FAIL " << workload.name << " frame " << checkpoint << ": frame was not reached" << std::endl;
+				success = false;
+			}
+			else if (hash->second != repeatedHash->second)
+			{
+				std::cout << "FAIL " << workload.name << " frame " << checkpoint << ": hash " << std::hex << repeatedHash->second
+					<< " differs from the first run " << hash->second << std::dec << std::endl;
+				success = false;
+			}
+			else
+			{
+				std::cout << "OK   " << workload.name << " frame " << checkpoint << " is deterministic" << std::endl;
+			}
+		}
+	}
+
+	return success;
+}
+
+static bool checkPerformance(const std::vector<Workload>& workloads, const std::map<std::string, WorkloadResult>& results, 
+	const std::filesystem::path& directory, double tolerance)
+{
+	std::map<std::string, double> baseline;
+	for (const auto& tokens : readLines(directory / BASELINE_FILE))
+	{
+		if (tokens.size() >= 2)
+			baseline[tokens[0]] = std::strtod(tokens[1].c_str(), nullptr);
+	}
+
+	bool success = true;
+	for (const auto& workload : workloads)
+	{
+		const auto framesPerSecond = results.at(workload.name).framesPerSecond;
+		auto expected = baseline.find(workload.name);
+		if (expected == baseline.end())
+		{
+			std::cout << "FAIL " << workload.name << ": " << framesPerSecond << " frames/s, no baseline, run with --update" << std::endl;
+			success = false;
+			continue;
+		}
+
+		const auto change = (framesPerSecond / expected->second - 1.0) * 100.0;
+		const bool regressed = change < -tolerance;
+		std::cout << (regressed ? "FAIL " : "OK   ") << workload.name << ": " << framesPerSecond << " frames/s, baseline "
+			<< expected->second << " (" << (change >= 0.0 ? "+" : "") << change << "%, tolerance " << tolerance << "%)" << std::endl;
+		success &= !regressed;
+	}
+
+	return success;
+}
+
+static void writeResults(const std::vector<Workload>& workloads, const std::map<std::string, WorkloadResult>& results, const std::filesystem::path& directory)
+{
+	std::ofstream goldens(directory / GOLDENS_FILE, std::ios::trunc);
+	std::ofstream baseline(directory / BASELINE_FILE, std::ios::trunc);
+	goldens << "# <workload> <frame> <framebuffer hash>" << std::endl;
+	baseline << "# <workload> <frames per second>" << std::endl;
+	for (const auto& workload : workloads)
+	{
+		const auto& result = results.at(workload.name);
+		for (const auto& [frame, hash] : result.hashes)
+			goldens << workload.name << " " << frame << " " << std::hex << hash << std::dec << std::endl;
+		baseline << workload.name << " " << result.framesPerSecond << std::endl;
+	}
+	std::cout << "Updated " << (directory / GOLDENS_FILE).string() << " and " << (directory / BASELINE_FILE).string() << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s <directory> [--check hashes|determinism|performance] [--tolerance <percent>] [--require-baseline] [--update]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const std::filesystem::path directory = argv[1];
+	std::string check = "all";
+	double tolerance = 10.0;
+	bool update = false;
+	bool requireBaseline = false;
+	for (int i = 2; i < argc; i++)
+	{
+		const std::string argument = argv[i];
+		if ((argument == "--check") && (i + 1 < argc))
+			check = argv[++i];
+		else if ((argument == "--tolerance") && (i + 1 < argc))
+			tolerance = std::strtod(argv[++i], nullptr);
+		else if (argument == "--update")
+			update = true;
+		else if (argument == "--require-baseline")
+			requireBaseline = true;
+		else
+			fprintf(stderr, "Ignoring unknown argument: %s\n", argument.c_str());
+	}
+
+	std::vector<Workload> workloads;
+	if (!readWorkloads(directory, workloads))
+		return EXIT_FAILURE;
+	if (workloads.empty())
+	{
+		std::cout << "No workloads in " << (directory / WORKLOADS_FILE).string() << ", skipping" << std::endl;
+		return SKIP_RETURN_CODE;
+	}
+
+	const bool measuresPerformance = update || (check == "all") || (check == "performance");
+	const int runs = measuresPerformance ? PERFORMANCE_RUNS : 1;
+	std::map<std::string, WorkloadResult> results;
+	for (const auto& workload : workloads)
+	{
+		auto& result = results[workload.name];
+		for (int run = 0; run < runs; run++)
+		{
+			WorkloadResult runResult = {};
+			if (!runWorkload(workload, runResult))
+				return EXIT_FAILURE;
+			if (run == 0)
+				result = std::move(runResult);
+			else
+				result.framesPerSecond = std::max(result.framesPerSecond, runResult.framesPerSecond);
+		}
+	}
+
+	if (update)
+	{
+		writeResults(workloads, results, directory);
+		return EXIT_SUCCESS;
+	}
+
+	// The baseline is machine specific, a machine without one can only skip the performance check
+	bool skipped = false;
+	bool baselineAvailable = true;
+	if (!std::filesystem::exists(directory / BASELINE_FILE) && !requireBaseline)
+	{
+		std::cout << "SKIP " << (directory / BASELINE_FILE).string() << " does not exist, create it with --update" << std::endl;
+		skipped = true;
+		baselineAvailable = false;
+	}
+
+	bool success = true;
+	if ((check == "all") || (check == "hashes"))
+		success &= checkHashes(workloads, results, directory);
+	if ((check == "all") || (check == "determinism"))
+		success &= checkDeterminism(workloads, results);
+	if (((check == "all") || (check == "performance")) && baselineAvailable)
+		success &= checkPerformance(workloads, results, directory, tolerance);
+
+	if (!success)
+		return EXIT_FAILURE;
+	// A single check which could not run is reported as skipped, "all" passes with the checks that ran
+	return (skipped && (check != "all")) ? SKIP_RETURN_CODE : EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+# Generates scroll-test.gb, the workload ROM of the regression tests.
+#
+# The ROM is written for this repository and may be redistributed with it. It contains no code or data of commercial
+# games and no boot logo (the emulator starts without a boot ROM), so it does not pass the logo check of real hardware.
+#
+# What it does (DMG mode, ROM only cartridge):
+# - turns the LCD off in VBlank, loads three tiles and fills the background map with a checkerboard of tile 1 and 2
+# - every frame: scrolls one pixel to the right, UP/DOWN scroll vertically, while A is held the palette is inverted
+#
+# Usage: make_test_rom.py [output], the output defaults to scroll-test.gb next to this script
+import os
+import sys
+
+ROM_SIZE = 0x8000
+ENTRY_POINT = 0x150
+
+# Register addresses relative to 0xFF00 (ldh)
+P1 = 0x00
+LCDC = 0x40
+SCY = 0x42
+SCX = 0x43
+LY = 0x44
+BGP = 0x47
+
+VBLANK_LINE = 144
+NORMAL_PALETTE = 0xE4
+INVERTED_PALETTE = 0x1B
+
+
+class Assembler:
+	def __init__(self, origin):
+		self.origin = origin
+		self.code = bytearray()
+		self.labels = {}
+		self.fixups = []
+
+	def address(self):
+		return self.origin + len(self.code)
+
+	def label(self, name):
+		self.labels[name] = self.address()
+
+	def emit(self, *values):
+		self.code.extend(values)
+
+	def relative_jump(self, opcode, label):
+		self.emit(opcode, 0)
+		self.fixups.append(("relative", len(self.code) - 1, label))
+
+	def absolute16(self, opcode, label):
+		self.emit(opcode, 0, 0)
+		self.fixups.append(("absolute", len(self.code) - 2, label))
+
+	def link(self):
+		for kind, offset, label in self.fixups:
+			target = self.labels[label]
+			if kind == "relative":
+				distance = target - (self.origin + offset + 1)
+				assert -128 <= distance <= 127, label
+				self.code[offset] = distance & 0xFF
+			else:
+				self.code[offset] = target & 0xFF
+				self.code[offset + 1] = target >> 8
+		return bytes(self.code)
+
+
+JR = 0x18
+JR_NZ = 0x20
+JR_NC = 0x30
+JR_C = 0x38
+
+
+def wait_for_vblank(asm, name):
+	# ldh a,(LY); cp VBLANK_LINE; jr c,name
+	asm.label(name)
+	asm.emit(0xF0, LY, 0xFE, VBLANK_LINE)
+	asm.relative_jump(JR_C, name)
+
+
+def wait_for_visible_lines(asm, name):
+	# ldh a,(LY); cp VBLANK_LINE; jr nc,name
+	asm.label(name)
+	asm.emit(0xF0, LY, 0xFE, VBLANK_LINE)
+	asm.relative_jump(JR_NC, name)
+
+
+def read_joypad(asm, select):
+	# ld a,select; ldh (P1),a; ldh a,(P1) twice to let the lines settle; ld b,a
+	asm.emit(0x3E, select, 0xE0, P1, 0xF0, P1, 0xF0, P1, 0x47)
+
+
+def tiles():
+	data = bytearray(16)                          # tile 0: blank
+	for _ in range(8):
+		data += bytes([0xFF, 0x00])               # tile 1: color 1
+	for row in range(8):
+		low = 0xF0 if row < 4 else 0x0F           # tile 2: color 3 and 2 quarters
+		data += bytes([low, 0xFF])
+	return bytes(data)
+
+
+def program():
+	asm = Assembler(ENTRY_POINT)
+	asm.emit(0xF3)                                # di
+	asm.emit(0x31, 0xFE, 0xFF)                    # ld sp,0xFFFE
+	wait_for_vblank(asm, "initial_vblank")
+	asm.emit(0xAF, 0xE0, LCDC)                    # xor a; ldh (LCDC),a
+
+	asm.emit(0x21, 0x00, 0x80)                    # ld hl,0x8000
+	asm.absolute16(0x11, "tiles")                 # ld de,tiles
+	asm.emit(0x01, len(tiles()), 0x00)            # ld bc,size
+	asm.label("copy_tiles")
+	asm.emit(0x1A, 0x22, 0x13, 0x0B)              # ld a,(de); ld (hl+),a; inc de; dec bc
+	asm.emit(0x78, 0xB1)                          # ld a,b; or c
+	asm.relative_jump(JR_NZ, "copy_tiles")
+
+	# Tile = ((x ^ y) & 1) + 1, x is bit 0 and y bit 5 of the map offset in l
+	asm.emit(0x21, 0x00, 0x98)                    # ld hl,0x9800
+	asm.label("fill_map")
+	asm.emit(0x7D, 0xCB, 0x37, 0x0F)              # ld a,l; swap a; rrca
+	asm.emit(0xAD, 0xE6, 0x01, 0x3C, 0x22)        # xor l; and 1; inc a; ld (hl+),a
+	asm.emit(0x7C, 0xFE, 0x9C)                    # ld a,h; cp 0x9C
+	asm.relative_jump(JR_NZ, "fill_map")
+
+	asm.emit(0x3E, NORMAL_PALETTE, 0xE0, BGP)     # ld a,NORMAL_PALETTE; ldh (BGP),a
+	asm.emit(0x3E, 0x91, 0xE0, LCDC)              # ld a,0x91; ldh (LCDC),a (LCD and background on, tiles at 0x8000)
+
+	asm.label("main_loop")
+	wait_for_visible_lines(asm, "wait_visible")
+	wait_for_vblank(asm, "wait_vblank")
+	asm.emit(0xF0, SCX, 0x3C, 0xE0, SCX)          # ldh a,(SCX); inc a; ldh (SCX),a
+
+	read_joypad(asm, 0x20)                        # directions, active low
+	asm.emit(0xCB, 0x58)                          # bit 3,b (down)
+	asm.relative_jump(JR_NZ, "not_down")
+	asm.emit(0xF0, SCY, 0x3C, 0xE0, SCY)          # ldh a,(SCY); inc a; ldh (SCY),a
+	asm.label("not_down")
+	asm.emit(0xCB, 0x50)                          # bit 2,b (up)
+	asm.relative_jump(JR_NZ, "not_up")
+	asm.emit(0xF0, SCY, 0x3D, 0xE0, SCY)          # ldh a,(SCY); dec a; ldh (SCY),a
+	asm.label("not_up")
+
+	read_joypad(asm, 0x10)                        # buttons, active low
+	asm.emit(0x3E, NORMAL_PALETTE)                # ld a,NORMAL_PALETTE
+	asm.emit(0xCB, 0x40)                          # bit 0,b (A)
+	asm.relative_jump(JR_NZ, "set_palette")
+	asm.emit(0x3E, INVERTED_PALETTE)              # ld a,INVERTED_PALETTE
+	asm.label("set_palette")
+	asm.emit(0xE0, BGP)                           # ldh (BGP),a
+	asm.emit(0x3E, 0x30, 0xE0, P1)                # ld a,0x30; ldh (P1),a
+	asm.relative_jump(JR, "main_loop")
+
+	asm.label("tiles")
+	asm.code += tiles()
+	return asm.link()
+
+
+def rom():
+	data = bytearray(ROM_SIZE)
+	data[0x100:0x104] = bytes([0x00, 0xC3, ENTRY_POINT & 0xFF, ENTRY_POINT >> 8])  # nop; jp ENTRY_POINT
+	title = b"GGBOYSCROLL"
+	data[0x134:0x134 + len(title)] = title
+	data[0x143] = 0x00                            # DMG only
+	data[0x147] = 0x00                            # ROM only
+	data[0x148] = 0x00                            # 32 KiB
+	data[0x149] = 0x00                            # no RAM
+	data[0x14A] = 0x01                            # not Japanese
+	data[0x14B] = 0x00
+
+	checksum = 0
+	for value in data[0x134:0x14D]:
+		checksum = (checksum - value - 1) & 0xFF
+	data[0x14D] = checksum
+
+	code = program()
+	data[ENTRY_POINT:ENTRY_POINT + len(code)] = code
+
+	global_checksum = sum(data) & 0xFFFF
+	data[0x14E] = global_checksum >> 8
+	data[0x14F] = global_checksum & 0xFF
+	return bytes(data)
+
+
+if __name__ == "__main__":
+	output = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(os.path.abspath(__file__)), "scroll-test.gb")
+	with open(output, "wb") as file:
+		file.write(rom())